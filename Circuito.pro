@@ -6,6 +6,11 @@
 
 QT       += core gui
 
+CONFIG += thread
+
+# CircuitoCompilado carrega o codigo gerado com dlopen
+unix: LIBS += -ldl
+
 greaterThan(QT_MAJOR_VERSION, 4): QT += widgets
 
 TARGET = Circuito
@@ -31,7 +36,19 @@ SOURCES += main.cpp\
     newcircuito.cpp \
     modificarsaida.cpp \
     bool3S.cpp \
-    porta.cpp
+    porta.cpp \
+    simuladorbits.cpp \
+    kernelsportas.cpp \
+    kernelsportas_avx2.cpp \
+    kernelsportas_avx512.cpp \
+    tabelaverdade.cpp \
+    circuitocompilado.cpp \
+    maquinavirtual.cpp \
+    bool3Svector.cpp \
+    otimizador.cpp \
+    grafoaig.cpp \
+    circuitoimutavel.cpp \
+    construtorcircuito.cpp
 
 HEADERS  += maincircuito.h \
     circuito.h \
@@ -40,7 +57,20 @@ HEADERS  += maincircuito.h \
     newcircuito.h \
     modificarsaida.h \
     bool3S.h \
-    porta.h
+    porta.h \
+    bool3S64.h \
+    simuladorbits.h \
+    kernelsportas.h \
+    kernelsportas_impl.h \
+    tabelaverdade.h \
+    circuitocompilado.h \
+    maquinavirtual.h \
+    bool3Svector.h \
+    otimizador.h \
+    grafoaig.h \
+    circuitofixo.h \
+    circuitoimutavel.h \
+    construtorcircuito.h
 
 FORMS    += maincircuito.ui \
     modificarconexao.ui \
@@ -0,0 +1,88 @@
+// Micro-benchmark dos kernels de avaliacao de portas (kernelsportas.h).
+// Para cada kernel disponivel no processador em uso, mede quantos padroes
+// (vetores de entrada) por segundo o SimuladorBits consegue simular.
+//
+// Compilacao (fora do Qt):
+// g++ -O2 -std=c++11 benchkernels.cpp bool3S.cpp porta.cpp circuito.cpp simuladorbits.cpp
+//     kernelsportas.cpp kernelsportas_avx2.cpp kernelsportas_avx512.cpp -o benchkernels
+// Uso: benchkernels [num_portas]
+
+#include <iostream>
+#include <chrono>
+#include <random>
+#include <string>
+#include <cstdlib>
+#include "circuito.h"
+#include "simuladorbits.h"
+
+using namespace std;
+
+// Cria um circuito aleatorio aciclico com NI entradas, NO saidas e NP portas,
+// em que cada porta soh recebe sinais das entradas ou de portas de id menor
+Circuito circuitoAleatorio(int NI, int NO, int NP, unsigned semente)
+{
+  static const char* tipos[] = {"NT", "AN", "NA", "OR", "NO", "XO", "NX"};
+  mt19937 gerador(semente);
+  Circuito C(NI, NO, NP);
+
+  for (int id=1; id<=NP; ++id)
+  {
+    string Tipo = tipos[gerador()%7];
+    int Nin = (Tipo=="NT" ? 1 : 2+gerador()%3);
+    C.setPort(id, Tipo, Nin);
+    for (int j=0; j<Nin; ++j)
+    {
+      // Metade das entradas vem de portas proximas, para formar caminhos longos
+      int orig;
+      if (id==1 || gerador()%4==0) orig = -1-int(gerador()%NI);
+      else orig = id-1-int(gerador()%min(id-1, 32));
+      C.setIdInPort(id, j, orig);
+    }
+  }
+  for (int id=1; id<=NO; ++id) C.setIdOutputCirc(id, NP-id+1);
+  return C;
+}
+
+int main(int argc, char** argv)
+{
+  int NP = (argc>1 ? atoi(argv[1]) : 100000);
+  const int NI = 32;
+  const int NO = 16;
+
+  cout << "Circuito aleatorio: " << NI << " entradas, " << NO << " saidas, "
+       << NP << " portas\n";
+  Circuito C = circuitoAleatorio(NI, NO, NP, 2017);
+  cout << "Profundidade: " << C.getProfundidade() << "\n\n";
+
+  for (const KernelPortas* K : kernelsDisponiveis())
+  {
+    SimuladorBits S(C, *K);
+
+    // Entradas aleatorias (apenas T e F)
+    mt19937_64 gerador(1);
+    vector<bool3S64> in_circ(NI*S.getNumPalavras());
+    for (auto& x : in_circ)
+    {
+      x.t = gerador();
+      x.f = ~x.t;
+    }
+
+    // Repete a simulacao por pelo menos 1 segundo
+    auto inicio = chrono::steady_clock::now();
+    double segundos;
+    long long Nblocos = 0;
+    do
+    {
+      S.simular(in_circ);
+      ++Nblocos;
+      segundos = chrono::duration<double>(chrono::steady_clock::now()-inicio).count();
+    } while (segundos < 1.0);
+
+    double padroes = double(Nblocos)*S.getNumPadroes();
+    cout << K->nome << "\t"
+         << S.getNumPadroes() << " padroes/bloco\t"
+         << padroes/segundos << " padroes/s\t"
+         << padroes*NP/segundos << " avaliacoes de porta/s\n";
+  }
+  return 0;
+}
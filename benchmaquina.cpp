@@ -0,0 +1,115 @@
+// Benchmark da maquina virtual (maquinavirtual.h) contra a simulacao de Circuito::simular.
+// O circuito de teste eh o circuito de circuito.txt replicado ateh ter cerca de
+// 1 milhao de portas: as entradas de cada copia vem das saidas da copia anterior.
+// Com um argumento "laco", a ultima copia realimenta a primeira, criando um laco.
+//
+// Compilacao (fora do Qt):
+// g++ -O2 -std=c++11 benchmaquina.cpp bool3S.cpp porta.cpp circuito.cpp maquinavirtual.cpp -o benchmaquina
+// Uso: benchmaquina [num_portas] [laco]
+
+#include <iostream>
+#include <chrono>
+#include <vector>
+#include <string>
+#include <cstdlib>
+#include "circuito.h"
+#include "maquinavirtual.h"
+
+using namespace std;
+
+// O circuito de circuito.txt (3 entradas, 3 saidas, 7 portas)
+const char* tipo_modelo[7] = {"OR", "AN", "NO", "NT", "NA", "XO", "NX"};
+const int Nin_modelo[7] = {3, 3, 2, 1, 3, 2, 2};
+const int orig_modelo[7][3] = {{2, -1, -2}, {-1, -2, 3}, {-2, -3, 0}, {2, 0, 0},
+                               {2, 1, 6}, {1, 4, 0}, {4, -3, 0}};
+
+// Cria o circuito com Ncopias copias do circuito modelo em cascata.
+// Se laco==true, a entrada -3 da primeira copia vem da ultima copia.
+Circuito circuitoReplicado(int Ncopias, bool laco)
+{
+  Circuito C(3, 3, 7*Ncopias);
+  for (int c=0; c<Ncopias; ++c)
+  {
+    int base = 7*c;
+    // As entradas -1, -2 e -3 da copia c vem das portas 5, 7 e 6 da copia anterior
+    int orig_entrada[3] = {-1, -2, (laco ? 7*(Ncopias-1)+6 : -3)};
+    if (c > 0)
+    {
+      orig_entrada[0] = base-7+5;
+      orig_entrada[1] = base-7+7;
+      orig_entrada[2] = base-7+6;
+    }
+    for (int p=0; p<7; ++p)
+    {
+      C.setPort(base+p+1, tipo_modelo[p], Nin_modelo[p]);
+      for (int j=0; j<Nin_modelo[p]; ++j)
+      {
+        int orig = orig_modelo[p][j];
+        C.setIdInPort(base+p+1, j, orig>0 ? base+orig : orig_entrada[-orig-1]);
+      }
+    }
+  }
+  int ultima = 7*(Ncopias-1);
+  C.setIdOutputCirc(1, ultima+5);
+  C.setIdOutputCirc(2, ultima+6);
+  C.setIdOutputCirc(3, ultima+7);
+  return C;
+}
+
+// Mede o tempo medio (em segundos) de uma chamada a f(), repetindo por pelo menos 1 segundo
+template <class Funcao>
+double medir(Funcao f)
+{
+  auto inicio = chrono::steady_clock::now();
+  double segundos;
+  int N = 0;
+  do
+  {
+    f();
+    ++N;
+    segundos = chrono::duration<double>(chrono::steady_clock::now()-inicio).count();
+  } while (segundos < 1.0);
+  return segundos/N;
+}
+
+int main(int argc, char** argv)
+{
+  int NP = (argc>1 ? atoi(argv[1]) : 1000000);
+  bool laco = (argc>2 && string(argv[2])=="laco");
+  int Ncopias = (NP+6)/7;
+  Circuito C = circuitoReplicado(Ncopias, laco);
+  NP = C.getNumPorts();
+  cout << "Circuito: " << NP << " portas, " << (C.aciclico() ? "sem" : "com") << " lacos\n";
+
+  // Traducao para o codigo da maquina
+  auto inicio = chrono::steady_clock::now();
+  MaquinaVirtual M(C);
+  double t_traducao = chrono::duration<double>(chrono::steady_clock::now()-inicio).count();
+  cout << "Traducao: " << M.getNumInstrucoes() << " instrucoes em " << 1e3*t_traducao << " ms\n";
+
+  vector<bool3S> in_circ = {bool3S::TRUE, bool3S::FALSE, bool3S::UNDEF};
+
+  double t_circuito = medir([&]()
+  {
+    C.simular(in_circ);
+  });
+  double t_maquina = medir([&]()
+  {
+    M.simular(in_circ);
+  });
+
+  // Confere os resultados
+  for (int id=1; id<=NP; ++id)
+  {
+    if (M.getOutputPort(id) != C.getOutputPort(id))
+    {
+      cerr << "Erro: resultados diferentes na porta " << id << endl;
+      return 1;
+    }
+  }
+
+  cout << "Circuito::simular:      " << 1e9*t_circuito/NP << " ns/porta\n";
+  cout << "MaquinaVirtual::simular: " << 1e9*t_maquina/NP << " ns/porta\n";
+  cout << "Aceleracao: " << t_circuito/t_maquina << "x\n";
+  return 0;
+}
@@ -0,0 +1,157 @@
+// Benchmark da avaliacao de portas: despacho por opcode (Circuito::simular, com os
+// operadores inline de bool3S) versus chamadas virtuais a Porta::simular.
+// O circuito de teste eh o circuito de circuito.txt replicado ateh ter cerca de
+// 1 milhao de portas: as entradas de cada copia vem das saidas da copia anterior.
+//
+// Compilacao (fora do Qt):
+// g++ -O2 -std=c++11 benchportas.cpp bool3S.cpp porta.cpp circuito.cpp -o benchportas
+// Uso: benchportas [num_portas]
+
+#include <iostream>
+#include <chrono>
+#include <vector>
+#include <cstdlib>
+#include "circuito.h"
+
+using namespace std;
+
+// O circuito de circuito.txt (3 entradas, 3 saidas, 7 portas)
+const char* tipo_modelo[7] = {"OR", "AN", "NO", "NT", "NA", "XO", "NX"};
+const int Nin_modelo[7] = {3, 3, 2, 1, 3, 2, 2};
+const int orig_modelo[7][3] = {{2, -1, -2}, {-1, -2, 3}, {-2, -3, 0}, {2, 0, 0},
+                               {2, 1, 6}, {1, 4, 0}, {4, -3, 0}};
+
+// Cria o circuito com Ncopias copias do circuito modelo em cascata
+Circuito circuitoReplicado(int Ncopias)
+{
+  Circuito C(3, 3, 7*Ncopias);
+  for (int c=0; c<Ncopias; ++c)
+  {
+    int base = 7*c;
+    // As entradas -1, -2 e -3 da copia c vem das portas 5, 7 e 6 da copia anterior
+    int orig_entrada[3] = {-1, -2, -3};
+    if (c > 0)
+    {
+      orig_entrada[0] = base-7+5;
+      orig_entrada[1] = base-7+7;
+      orig_entrada[2] = base-7+6;
+    }
+    for (int p=0; p<7; ++p)
+    {
+      C.setPort(base+p+1, tipo_modelo[p], Nin_modelo[p]);
+      for (int j=0; j<Nin_modelo[p]; ++j)
+      {
+        int orig = orig_modelo[p][j];
+        C.setIdInPort(base+p+1, j, orig>0 ? base+orig : orig_entrada[-orig-1]);
+      }
+    }
+  }
+  int ultima = 7*(Ncopias-1);
+  C.setIdOutputCirc(1, ultima+5);
+  C.setIdOutputCirc(2, ultima+6);
+  C.setIdOutputCirc(3, ultima+7);
+  return C;
+}
+
+// Mede o tempo medio (em segundos) de uma chamada a f(), repetindo por pelo menos 1 segundo
+template <class Funcao>
+double medir(Funcao f)
+{
+  auto inicio = chrono::steady_clock::now();
+  double segundos;
+  int N = 0;
+  do
+  {
+    f();
+    ++N;
+    segundos = chrono::duration<double>(chrono::steady_clock::now()-inicio).count();
+  } while (segundos < 1.0);
+  return segundos/N;
+}
+
+int main(int argc, char** argv)
+{
+  int NP = (argc>1 ? atoi(argv[1]) : 1000000);
+  int Ncopias = (NP+6)/7;
+  Circuito C = circuitoReplicado(Ncopias);
+  NP = C.getNumPorts();
+  cout << "Circuito: " << NP << " portas, profundidade " << C.getProfundidade() << "\n";
+
+  // A ordem de avaliacao (por nivel), a mesma usada por Circuito::simular
+  if (!C.aciclico())
+  {
+    cerr << "Erro: o circuito deveria ser aciclico\n";
+    return 1;
+  }
+  vector< vector<int> > por_nivel(C.getProfundidade()+1);
+  for (int id=1; id<=NP; ++id) por_nivel[C.getNivelPort(id)].push_back(id);
+  vector<int> ordem;
+  for (auto& nivel : por_nivel) ordem.insert(ordem.end(), nivel.begin(), nivel.end());
+
+  // O mesmo circuito com um objeto Porta por porta (caminho virtual)
+  vector<ptr_Porta> portas(NP+1, nullptr);
+  vector< vector<int> > id_in(NP+1);
+  for (int id=1; id<=NP; ++id)
+  {
+    portas[id] = novaPorta(toTipoPorta(C.getNamePort(id)), C.getNumInputsPort(id));
+    for (int j=0; j<C.getNumInputsPort(id); ++j) id_in[id].push_back(C.getIdInPort(id,j));
+  }
+
+  vector<bool3S> in_circ = {bool3S::TRUE, bool3S::FALSE, bool3S::UNDEF};
+
+  // 1) Caminho virtual, como na versao original de Circuito::simular:
+  //    um vector de entradas alocado para cada porta
+  double t_virtual = medir([&]()
+  {
+    for (int id : ordem)
+    {
+      vector<bool3S> in_port(id_in[id].size());
+      for (size_t j=0; j<in_port.size(); ++j)
+      {
+        int orig = id_in[id][j];
+        in_port[j] = (orig>0 ? portas[orig]->getOutput() : in_circ[-orig-1]);
+      }
+      portas[id]->simular(in_port);
+    }
+  });
+
+  // 2) Caminho virtual, reaproveitando o vector de entradas
+  vector<bool3S> in_port;
+  double t_virtual_reap = medir([&]()
+  {
+    for (int id : ordem)
+    {
+      in_port.resize(id_in[id].size());
+      for (size_t j=0; j<in_port.size(); ++j)
+      {
+        int orig = id_in[id][j];
+        in_port[j] = (orig>0 ? portas[orig]->getOutput() : in_circ[-orig-1]);
+      }
+      portas[id]->simular(in_port);
+    }
+  });
+
+  // 3) Despacho por opcode (Circuito::simular)
+  double t_opcode = medir([&]()
+  {
+    C.simular(in_circ);
+  });
+
+  // Confere os resultados
+  for (int id=1; id<=NP; ++id)
+  {
+    if (portas[id]->getOutput() != C.getOutputPort(id))
+    {
+      cerr << "Erro: resultados diferentes na porta " << id << endl;
+      return 1;
+    }
+  }
+
+  cout << "virtual (vector por porta):    " << 1e9*t_virtual/NP << " ns/porta\n";
+  cout << "virtual (vector reaproveitado): " << 1e9*t_virtual_reap/NP << " ns/porta\n";
+  cout << "opcode (Circuito::simular):     " << 1e9*t_opcode/NP << " ns/porta\n";
+  cout << "Aceleracao em relacao ao caminho virtual original: " << t_virtual/t_opcode << "x\n";
+
+  for (auto p : portas) delete p;
+  return 0;
+}
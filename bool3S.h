@@ -13,18 +13,63 @@ enum class bool3S {
 
 // Os operadores logicos para a classe bool3S
 // Podem ser usados para facilitar a implementacao dos metodos de simulacao de portas logicas
+// Sao implementados inline, sem desvios condicionais, por consulta a tabelas indexadas
+// pelos valores dos operandos (o indice de um par x1,x2 eh 4*x1+x2).
+
+// As tabelas verdade (uso interno dos operadores)
+namespace tabela3S {
+  const bool3S U=bool3S::UNDEF, F=bool3S::FALSE, T=bool3S::TRUE;
+  const bool3S NOT[4] = {U, T, F, U};
+  const bool3S AND[16] = {U, F, U, U,
+                          F, F, F, F,
+                          U, F, T, U,
+                          U, U, U, U};
+  const bool3S OR[16]  = {U, U, T, U,
+                          U, F, T, U,
+                          T, T, T, U,
+                          U, U, U, U};
+  const bool3S XOR[16] = {U, U, U, U,
+                          U, F, T, U,
+                          U, T, F, U,
+                          U, U, U, U};
+  inline int indice(bool3S x1, bool3S x2)
+  {
+    return (static_cast<int>(x1)<<2) | static_cast<int>(x2);
+  }
+}
 
 // NOT 3S
-bool3S operator~(bool3S x);
+inline bool3S operator~(bool3S x)
+{
+  return tabela3S::NOT[static_cast<int>(x)];
+}
 // AND 3S
-bool3S operator&(bool3S x1, bool3S x2);
-void operator&=(bool3S& x1, bool3S x2);
+inline bool3S operator&(bool3S x1, bool3S x2)
+{
+  return tabela3S::AND[tabela3S::indice(x1,x2)];
+}
+inline void operator&=(bool3S& x1, bool3S x2)
+{
+  x1 = x1 & x2;
+}
 // OR 3S
-bool3S operator|(bool3S x1, bool3S x2);
-void operator|=(bool3S& x1, bool3S x2);
+inline bool3S operator|(bool3S x1, bool3S x2)
+{
+  return tabela3S::OR[tabela3S::indice(x1,x2)];
+}
+inline void operator|=(bool3S& x1, bool3S x2)
+{
+  x1 = x1 | x2;
+}
 // XOR 3S
-bool3S operator^(bool3S x1, bool3S x2);
-void operator^=(bool3S& x1, bool3S x2);
+inline bool3S operator^(bool3S x1, bool3S x2)
+{
+  return tabela3S::XOR[tabela3S::indice(x1,x2)];
+}
+inline void operator^=(bool3S& x1, bool3S x2)
+{
+  x1 = x1 ^ x2;
+}
 
 // Os operadores de incremento/decremento para a classe bool3S
 
@@ -0,0 +1,85 @@
+#ifndef _BOOL3S64_H_
+#define _BOOL3S64_H_
+
+#include <cstdint>
+#include "bool3S.h"
+
+// Um tipo de dados (bool3S64) que representa 64 valores bool3S independentes
+// (64 "padroes" de simulacao), na forma "dual-rail":
+// - o bit k da palavra f eh 1 se o k-esimo valor pode ser FALSE
+// - o bit k da palavra t eh 1 se o k-esimo valor pode ser TRUE
+// Portanto: FALSE -> (f=1,t=0), TRUE -> (f=0,t=1) e UNDEF -> (f=1,t=1).
+// A combinacao (f=0,t=0) nunca ocorre.
+// Com essa representacao, cada operacao logica sobre os 64 valores custa poucas
+// instrucoes sobre palavras de 64 bits, com exatamente a mesma semantica dos operadores de bool3S.
+struct bool3S64
+{
+  uint64_t f;
+  uint64_t t;
+
+  // Construtor default: os 64 valores bool3S::UNDEF
+  bool3S64(): f(~uint64_t(0)), t(~uint64_t(0)) {}
+  // Construtor a partir das duas palavras
+  bool3S64(uint64_t F, uint64_t T): f(F), t(T) {}
+  // Construtor com os 64 valores iguais a B
+  explicit bool3S64(bool3S B):
+    f(B==bool3S::TRUE ? uint64_t(0) : ~uint64_t(0)),
+    t(B==bool3S::FALSE ? uint64_t(0) : ~uint64_t(0))
+  {}
+
+  // Retorna o k-esimo valor (k de 0 a 63)
+  bool3S get(int k) const
+  {
+    bool F = (f>>k) & 1;
+    bool T = (t>>k) & 1;
+    if (F && T) return bool3S::UNDEF;
+    return (T ? bool3S::TRUE : bool3S::FALSE);
+  }
+
+  // Fixa o k-esimo valor (k de 0 a 63)
+  void set(int k, bool3S B)
+  {
+    uint64_t mask = uint64_t(1)<<k;
+    if (B==bool3S::TRUE) f &= ~mask; else f |= mask;
+    if (B==bool3S::FALSE) t &= ~mask; else t |= mask;
+  }
+};
+
+// Os operadores logicos para a classe bool3S64 (os mesmos de bool3S, aplicados aos 64 valores)
+
+// NOT 3S: troca as palavras
+inline bool3S64 operator~(bool3S64 x)
+{
+  return bool3S64(x.t, x.f);
+}
+
+// AND 3S: pode ser TRUE se ambos podem ser TRUE; pode ser FALSE se algum pode ser FALSE
+inline bool3S64 operator&(bool3S64 x1, bool3S64 x2)
+{
+  return bool3S64(x1.f | x2.f, x1.t & x2.t);
+}
+
+// OR 3S: pode ser TRUE se algum pode ser TRUE; pode ser FALSE se ambos podem ser FALSE
+inline bool3S64 operator|(bool3S64 x1, bool3S64 x2)
+{
+  return bool3S64(x1.f & x2.f, x1.t | x2.t);
+}
+
+// XOR 3S: pode ser TRUE se podem ser diferentes; pode ser FALSE se podem ser iguais
+inline bool3S64 operator^(bool3S64 x1, bool3S64 x2)
+{
+  return bool3S64((x1.f & x2.f) | (x1.t & x2.t),
+                  (x1.f & x2.t) | (x1.t & x2.f));
+}
+
+inline bool operator==(bool3S64 x1, bool3S64 x2)
+{
+  return x1.f==x2.f && x1.t==x2.t;
+}
+
+inline bool operator!=(bool3S64 x1, bool3S64 x2)
+{
+  return !(x1==x2);
+}
+
+#endif // _BOOL3S64_H_
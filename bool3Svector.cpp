@@ -0,0 +1,165 @@
+#include <stdexcept>
+#include "bool3Svector.h"
+
+///
+/// CLASSE BOOL3SVECTOR
+///
+
+namespace {
+
+// O numero de palavras necessarias para Num valores
+int numPalavras(int Num)
+{
+  return (Num+63)/64;
+}
+
+// O numero de bits iguais a 1 em x
+int contarBits(uint64_t x)
+{
+#if defined(__GNUC__)
+  return __builtin_popcountll(x);
+#else
+  int n = 0;
+  for (; x!=0; x &= x-1) ++n;
+  return n;
+#endif
+}
+
+// Os 64 bits do trilho (f ou t) a partir do bit pos do vetor de palavras P
+uint64_t extrair(const std::vector<bool3S64>& P, uint64_t bool3S64::*trilho, int pos)
+{
+  size_t q = pos/64;
+  int r = pos%64;
+  uint64_t x = P[q].*trilho >> r;
+  if (r>0 && q+1<P.size()) x |= P[q+1].*trilho << (64-r);
+  return x;
+}
+
+} // namespace
+
+/// Cria um vetor com Num valores iguais a B
+bool3SVector::bool3SVector(int Num, bool3S B)
+    : N(0),
+      palavras()
+{
+  resize(Num, B);
+}
+
+/// Conversao a partir de um std::vector<bool3S>
+bool3SVector::bool3SVector(const std::vector<bool3S>& V)
+    : N(int(V.size())),
+      palavras(numPalavras(int(V.size())))
+{
+  for (int i=0; i<N; ++i) palavras[i/64].set(i%64, V[i]);
+}
+
+/// Conversao para std::vector<bool3S>
+std::vector<bool3S> bool3SVector::toVector() const
+{
+  std::vector<bool3S> V(N);
+  for (int i=0; i<N; ++i) V[i] = palavras[i/64].get(i%64);
+  return V;
+}
+
+/// Redimensiona o vetor; os novos valores sao iguais a B
+void bool3SVector::resize(int Num, bool3S B)
+{
+  if (Num < 0) throw std::invalid_argument("resize: invalid size");
+  int i = N;
+  palavras.resize(numPalavras(Num));
+  // Os novos valores da ultima palavra antiga, depois as novas palavras inteiras
+  for (; i<Num && i%64!=0; ++i) palavras[i/64].set(i%64, B);
+  for (; i<Num; i+=64) palavras[i/64] = bool3S64(B);
+  N = Num;
+  // Os bits que sobram na ultima palavra sao UNDEF
+  if (N%64 != 0)
+  {
+    uint64_t sobra = ~uint64_t(0) << (N%64);
+    palavras.back().f |= sobra;
+    palavras.back().t |= sobra;
+  }
+}
+
+/// Retorna o i-esimo valor
+bool3S bool3SVector::get(int i) const
+{
+  if (i<0 || i>=N) throw std::out_of_range("get: invalid index");
+  return palavras[i/64].get(i%64);
+}
+
+/// Fixa o i-esimo valor
+void bool3SVector::set(int i, bool3S B)
+{
+  if (i<0 || i>=N) throw std::out_of_range("set: invalid index");
+  palavras[i/64].set(i%64, B);
+}
+
+/// Retorna o numero de valores iguais a B
+int bool3SVector::contar(bool3S B) const
+{
+  int n = 0;
+  for (const bool3S64& P : palavras)
+  {
+    switch (B)
+    {
+    case bool3S::TRUE:  n += contarBits(~P.f & P.t); break;
+    case bool3S::FALSE: n += contarBits(P.f & ~P.t); break;
+    case bool3S::UNDEF:
+    default:            n += contarBits(P.f & P.t); break;
+    }
+  }
+  // Os bits que sobram na ultima palavra sao UNDEF e nao devem ser contados
+  if (B==bool3S::UNDEF) n -= 64*getNumPalavras()-N;
+  return n;
+}
+
+/// Retorna o vetor formado pelos Num valores a partir do ini-esimo
+bool3SVector bool3SVector::fatia(int ini, int Num) const
+{
+  if (ini<0 || Num<0 || ini+Num>N) throw std::out_of_range("fatia: invalid range");
+  bool3SVector V(Num);
+  for (int w=0; w<V.getNumPalavras(); ++w)
+  {
+    V.palavras[w].f = extrair(palavras, &bool3S64::f, ini+64*w);
+    V.palavras[w].t = extrair(palavras, &bool3S64::t, ini+64*w);
+  }
+  // Refaz os bits que sobram na ultima palavra
+  V.resize(Num);
+  return V;
+}
+
+/// Os operadores logicos
+bool3SVector bool3SVector::operator~() const
+{
+  bool3SVector V(*this);
+  for (bool3S64& P : V.palavras) P = ~P;
+  return V;
+}
+
+bool3SVector& bool3SVector::operator&=(const bool3SVector& V)
+{
+  if (V.N != N) throw std::invalid_argument("operator&: incompatible sizes");
+  for (size_t w=0; w<palavras.size(); ++w) palavras[w] = palavras[w] & V.palavras[w];
+  return *this;
+}
+
+bool3SVector& bool3SVector::operator|=(const bool3SVector& V)
+{
+  if (V.N != N) throw std::invalid_argument("operator|: incompatible sizes");
+  for (size_t w=0; w<palavras.size(); ++w) palavras[w] = palavras[w] | V.palavras[w];
+  return *this;
+}
+
+bool3SVector& bool3SVector::operator^=(const bool3SVector& V)
+{
+  if (V.N != N) throw std::invalid_argument("operator^: incompatible sizes");
+  for (size_t w=0; w<palavras.size(); ++w) palavras[w] = palavras[w] ^ V.palavras[w];
+  return *this;
+}
+
+/// Impressao
+std::ostream& operator<<(std::ostream& O, const bool3SVector& V)
+{
+  for (int i=0; i<V.size(); ++i) O << V.get(i);
+  return O;
+}
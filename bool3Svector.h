@@ -0,0 +1,106 @@
+#ifndef _BOOL3SVECTOR_H_
+#define _BOOL3SVECTOR_H_
+
+#include <iostream>
+#include <vector>
+#include "bool3S.h"
+#include "bool3S64.h"
+
+///
+/// CLASSE BOOL3SVECTOR
+///
+
+// Um vetor de valores bool3S compactado em palavras bool3S64 (ver bool3S64.h):
+// o i-esimo valor eh o bit i%64 da palavra i/64, na forma dual-rail.
+// Cada valor ocupa 2 bits (contra os sizeof(bool3S) bytes de um std::vector<bool3S>),
+// e as operacoes logicas entre vetores sao feitas 64 valores de cada vez.
+// Os bits da ultima palavra que nao correspondem a nenhum valor sao sempre UNDEF
+// (nenhuma operacao logica transforma UNDEF em outro valor), de modo que as palavras
+// podem ser processadas inteiras.
+class bool3SVector
+{
+private:
+  // O numero de valores
+  int N;
+  // As palavras (N/64 arredondado para cima)
+  std::vector<bool3S64> palavras;
+
+public:
+  // Construtor default: vetor vazio
+  bool3SVector(): N(0), palavras() {}
+  // Cria um vetor com Num valores iguais a B
+  // Se o parametro for invalido, gera excecao.
+  explicit bool3SVector(int Num, bool3S B=bool3S::UNDEF);
+  // Conversao a partir de um std::vector<bool3S>
+  explicit bool3SVector(const std::vector<bool3S>& V);
+
+  // Conversao para std::vector<bool3S>
+  std::vector<bool3S> toVector() const;
+
+  // O numero de valores
+  int size() const
+  {
+    return N;
+  }
+  // Redimensiona o vetor; os novos valores sao iguais a B
+  // Se o parametro for invalido, gera excecao.
+  void resize(int Num, bool3S B=bool3S::UNDEF);
+
+  // Retorna o i-esimo valor
+  // Gera excecao se o parametro for invalido.
+  bool3S get(int i) const;
+  // Fixa o i-esimo valor
+  // Gera excecao se algum parametro for invalido.
+  void set(int i, bool3S B);
+
+  // O numero de palavras e a w-esima palavra (64 valores), para processamento por palavra
+  int getNumPalavras() const
+  {
+    return int(palavras.size());
+  }
+  bool3S64 getPalavra(int w) const
+  {
+    return palavras.at(w);
+  }
+
+  // Retorna o numero de valores iguais a B
+  int contar(bool3S B) const;
+
+  // Retorna o vetor formado pelos Num valores a partir do ini-esimo
+  // Gera excecao se algum parametro for invalido.
+  bool3SVector fatia(int ini, int Num) const;
+
+  // Os operadores logicos, aplicados valor a valor (com a mesma semantica dos operadores de bool3S)
+  // Os operadores binarios geram excecao se os vetores tiverem tamanhos diferentes.
+  bool3SVector operator~() const;
+  bool3SVector& operator&=(const bool3SVector& V);
+  bool3SVector& operator|=(const bool3SVector& V);
+  bool3SVector& operator^=(const bool3SVector& V);
+
+  bool operator==(const bool3SVector& V) const
+  {
+    return N==V.N && palavras==V.palavras;
+  }
+  bool operator!=(const bool3SVector& V) const
+  {
+    return !operator==(V);
+  }
+};
+
+inline bool3SVector operator&(bool3SVector V1, const bool3SVector& V2)
+{
+  return V1 &= V2;
+}
+inline bool3SVector operator|(bool3SVector V1, const bool3SVector& V2)
+{
+  return V1 |= V2;
+}
+inline bool3SVector operator^(bool3SVector V1, const bool3SVector& V2)
+{
+  return V1 ^= V2;
+}
+
+// Impressao (imprime os valores em sequencia, como ? T F)
+std::ostream& operator<<(std::ostream& O, const bool3SVector& V);
+
+#endif // _BOOL3SVECTOR_H_
@@ -1,79 +1,242 @@
 #include <fstream>
+#include <algorithm>
+#include <functional>
+#include <atomic>
+#include <mutex>
+#include <utility>
 #include "circuito.h"
 
 ///
 /// CLASSE CIRCUITO
 ///
 
+namespace {
+
+// O numero de ordens de avaliacao jah calculadas, em todos os circuitos (ver Circuito::versao)
+std::atomic<unsigned long> Nversoes(0);
+
+// Empacota os N valores de V em pac, com 2 bits por valor (4 valores por char)
+void empacotar(const bool3S* V, int N, std::string& pac)
+{
+  pac.assign((N+3)/4, '\0');
+  for (int i = 0; i < N; ++i) {
+      pac[i/4] = char(pac[i/4] | (static_cast<int>(V[i]) << (2*(i%4))));
+  }
+}
+
+// Retorna o i-esimo valor empacotado em pac
+bool3S desempacotar(const std::string& pac, int i)
+{
+  return static_cast<bool3S>((static_cast<unsigned char>(pac[i/4]) >> (2*(i%4))) & 3);
+}
+
+} // namespace
+
 /// ***********************
 /// Inicializacao e finalizacao
 /// ***********************
 
-/// Construtor por copia
+/// Copia da estrutura: apenas as portas e a conectividade.
+/// A ordem de avaliacao serah recalculada pela copia quando for necessaria.
+Circuito::Estrutura::Estrutura(const Estrutura& S)
+    : tipo_port(S.tipo_port),
+      Nin_port(S.Nin_port),
+      ini_in(S.ini_in),
+      id_in(S.id_in),
+      Nlixo(S.Nlixo),
+      id_out(S.id_out),
+      ordem_ok(false),
+      trava_ordem(),
+      versao(0),
+      ordem(),
+      Nacicl(0),
+      Nniveis(0),
+      nivel(),
+      ini_fanout(),
+      fanout(),
+      ini_fanout_in(),
+      fanout_in(),
+      ini_comp(),
+      comp(),
+      ini_fila(),
+      din_ok(false),
+      fanout_din(),
+      topo_ok(false),
+      ordem_din(),
+      pos_din(),
+      nivel_din(),
+      niveis_ok(false),
+      pend_din(),
+      pendente_din(),
+      marca_din(),
+      frente_din(),
+      tras_din(),
+      pos_aux_din(),
+      heap_din()
+{
+}
+
+/// A estrutura de um circuito vazio, compartilhada por todos os circuitos vazios
+const std::shared_ptr<Circuito::Estrutura>& Circuito::estruturaVazia()
+{
+  static const std::shared_ptr<Estrutura> vazia = std::make_shared<Estrutura>();
+  return vazia;
+}
+
+/// O estado de simulacao de um circuito vazio, compartilhado por todos os circuitos vazios
+const std::shared_ptr<EstadoSimulacao>& Circuito::estadoVazio()
+{
+  static const std::shared_ptr<EstadoSimulacao> vazio = std::make_shared<EstadoSimulacao>();
+  return vazio;
+}
+
+/// Se a estrutura estiver compartilhada com outras copias do circuito,
+/// passa a usar uma copia propria (copia na primeira modificacao)
+void Circuito::separarEstrutura()
+{
+  if (estr.use_count() > 1) estr = std::make_shared<Estrutura>(*estr);
+}
+
+/// Idem, para o estado da simulacao
+void Circuito::separarEstado()
+{
+  if (estado.use_count() > 1) estado = std::make_shared<EstadoSimulacao>(*estado);
+}
+
+/// Construtor por copia: a estrutura e o estado da simulacao sao compartilhados com C
 Circuito::Circuito(const Circuito& C)
     : Nin_circ(C.Nin_circ),
-      ports(C.ports.size(),nullptr),
-      out_circ(C.out_circ),
-      id_in(C.id_in),
-      id_out(C.id_out)
+      estr(C.estr),
+      estado(C.estado),
+      cone_ok(false),
+      saidas_cone(),
+      ordem_cone(),
+      Nacicl_cone(0),
+      comp_cone(),
+      demanda_ok(false),
+      marca_demanda(),
+      Ndemandas(0),
+      laco_demanda(),
+      ordem_in_demanda(),
+      custo_demanda(),
+      reordenar_demanda(C.reordenar_demanda),
+      Navaliadas_demanda(0),
+      pilha_demanda(),
+      cache_max(C.cache_max),
+      cache_bytes(0),
+      cache_lru(),
+      cache_mapa(),
+      cache_acertos(0),
+      cache_falhas(0),
+      chave_cache()
 {
-    for (size_t i=0; i<C.ports.size(); ++i){
-        if(C.ports.at(i)!=nullptr) ports.at(i) = C.ports.at(i)->clone();
-    }
 }
 
 /// Construtor por movimento
 Circuito::Circuito(Circuito&& C) noexcept
     : Nin_circ(C.Nin_circ),
-      ports(),
-      out_circ(),
-      id_in(),
-      id_out()
-{
-    ports.swap(C.ports);
-    out_circ.swap(C.out_circ);
-    id_in.swap(C.id_in);
-    id_out.swap(C.id_out);
+      estr(std::move(C.estr)),
+      estado(std::move(C.estado)),
+      cone_ok(false),
+      saidas_cone(),
+      ordem_cone(),
+      Nacicl_cone(0),
+      comp_cone(),
+      demanda_ok(false),
+      marca_demanda(),
+      Ndemandas(0),
+      laco_demanda(),
+      ordem_in_demanda(),
+      custo_demanda(),
+      reordenar_demanda(C.reordenar_demanda),
+      Navaliadas_demanda(0),
+      pilha_demanda(),
+      cache_max(C.cache_max),
+      cache_bytes(C.cache_bytes),
+      cache_lru(),
+      cache_mapa(),
+      cache_acertos(C.cache_acertos),
+      cache_falhas(C.cache_falhas),
+      chave_cache()
+{
+    cache_lru.swap(C.cache_lru);
+    cache_mapa.swap(C.cache_mapa);
     C.Nin_circ = 0;
+    C.estr = estruturaVazia();
+    C.estado = estadoVazio();
+    C.cone_ok = false;
+    C.demanda_ok = false;
+    C.cache_bytes = 0;
 }
 
 /// Limpa todo o conteudo do circuito.
 void Circuito::clear() noexcept
 {
     Nin_circ = 0;
-    out_circ.clear();
-    id_in.clear();
-    id_out.clear();
-    for (auto p : ports) delete p;
-    ports.clear();
+    estr = estruturaVazia();
+    estado = estadoVazio();
+    cone_ok = false;
+    saidas_cone.clear();
+    ordem_cone.clear();
+    Nacicl_cone = 0;
+    comp_cone.clear();
+    demanda_ok = false;
+    marca_demanda.clear();
+    laco_demanda.clear();
+    ordem_in_demanda.clear();
+    custo_demanda.clear();
+    pilha_demanda.clear();
+    Navaliadas_demanda = 0;
+    invalidarCache();
 }
 
-/// Operador de atribuicao por copia
+/// Esvazia o cache de resultados (o orcamento e os contadores sao mantidos)
+void Circuito::invalidarCache() noexcept
+{
+    cache_lru.clear();
+    cache_mapa.clear();
+    cache_bytes = 0;
+}
+
+/// Operador de atribuicao por copia: a estrutura e o estado da simulacao sao compartilhados com C.
+/// Como no construtor por copia, as configuracoes (orcamento do cache e reordenacao da
+/// avaliacao sob demanda) sao copiadas, mas o cache comeca vazio e com os contadores zerados.
 Circuito& Circuito::operator=(const Circuito& C)
 {
     if (this == &C) return *this;
     clear();
     Nin_circ = C.Nin_circ;
-    ports.resize(C.ports.size(),nullptr);
-    out_circ = C.out_circ;
-    id_in = C.id_in;
-    id_out = C.id_out;
-    for (size_t i=0; i<C.ports.size(); ++i){
-        if(C.ports.at(i)!=nullptr) ports.at(i) = C.ports.at(i)->clone();
-    }
+    estr = C.estr;
+    estado = C.estado;
+    reordenar_demanda = C.reordenar_demanda;
+    cache_max = C.cache_max;
+    cache_acertos = 0;
+    cache_falhas = 0;
     return *this;
 }
 
-/// Operador de atribuicao por movimento
+/// Operador de atribuicao por movimento: como no construtor por movimento, as configuracoes,
+/// o cache e os seus contadores passam para este circuito
 Circuito& Circuito::operator=(Circuito&& C) noexcept
 {
+    if (this == &C) return *this;
     clear();
     Nin_circ = C.Nin_circ;
-    out_circ.swap(C.out_circ);
-    id_in.swap(C.id_in);
-    id_out.swap(C.id_out);
-    ports.swap(C.ports);
+    std::swap(estr, C.estr);
+    std::swap(estado, C.estado);
+    reordenar_demanda = C.reordenar_demanda;
+    cache_max = C.cache_max;
+    cache_bytes = C.cache_bytes;
+    cache_lru.swap(C.cache_lru);
+    cache_mapa.swap(C.cache_mapa);
+    cache_acertos = C.cache_acertos;
+    cache_falhas = C.cache_falhas;
     C.Nin_circ = 0;
+    C.estr = estruturaVazia();
+    C.estado = estadoVazio();
+    C.cone_ok = false;
+    C.demanda_ok = false;
+    C.invalidarCache();
     return *this;
 }
 
@@ -84,10 +247,40 @@ void Circuito::resize(int NI, int NO, int NP)
     throw std::invalid_argument("resize: invalid parameter(s)");
   clear();
   Nin_circ = NI;
-  out_circ.resize(NO, bool3S::UNDEF);
-  id_out.resize(NO,0);
-  ports.resize(NP,nullptr);
-  id_in.resize(NP, std::vector<int>(0));
+  // Uma estrutura e um estado novos, que nao sao compartilhados com nenhuma copia
+  estr = std::make_shared<Estrutura>();
+  estr->id_out.resize(NO,0);
+  estr->tipo_port.resize(NP, TipoPorta::NT);
+  estr->Nin_port.resize(NP, 0);
+  estr->ini_in.resize(NP, 0);
+  iniciarEstado();
+}
+
+/// Cria um estado de simulacao proprio, com os valores dos sinais e das saidas indefinidos
+/// ateh a primeira simulacao
+void Circuito::iniciarEstado()
+{
+  estado = std::make_shared<EstadoSimulacao>();
+  estado->Nin_circ = Nin_circ;
+  estado->valor.resize(Nin_circ+1+getNumPorts(), bool3S::UNDEF);
+  estado->out_circ.resize(getNumOutputs(), bool3S::UNDEF);
+}
+
+/// Reorganiza o vetor id_in, eliminando o espaco abandonado pelas portas
+/// cujas origens foram realocadas.
+void Circuito::compactar()
+{
+  Estrutura& Est = *estr;
+  std::vector<int> novo_id_in;
+  novo_id_in.reserve(Est.id_in.size()-Est.Nlixo);
+  for (int i=0; i<getNumPorts(); ++i)
+  {
+    int ini = int(novo_id_in.size());
+    novo_id_in.insert(novo_id_in.end(), Est.id_in.begin()+Est.ini_in[i], Est.id_in.begin()+Est.ini_in[i]+Est.Nin_port[i]);
+    Est.ini_in[i] = ini;
+  }
+  Est.id_in.swap(novo_id_in);
+  Est.Nlixo = 0;
 }
 
 /// ***********************
@@ -97,22 +290,24 @@ void Circuito::resize(int NI, int NO, int NP)
 /// Testa circuito valido
 bool Circuito::valid() const
 {
+  const Estrutura& Est = *estr;
   int id;
   // Testa o numero de entradas, saidas e portas
   if (getNumInputs()<=0 || getNumOutputs()<=0 || getNumPorts()<=0) return false;
-  // Testa cada porta
+  // Testa cada porta (percorrendo diretamente os vetores, sem as checagens das funcoes de consulta)
   for (id=1; id<=getNumPorts(); ++id)
   {
-    if (ports.at(id-1)==nullptr) return false;
-    for (int j=0; j<getNumInputsPort(id); ++j)
+    if (Est.Nin_port[id-1]==0) return false;
+    const int* orig = Est.id_in.data()+Est.ini_in[id-1];
+    for (int j=0; j<Est.Nin_port[id-1]; ++j)
     {
-      if (!validIdOrig(getIdInPort(id,j))) return false;
+      if (!validIdOrig(orig[j])) return false;
     }
   }
   // Testa cada saida
   for (id=1; id<=getNumOutputs(); ++id)
   {
-    if (!validIdOrig(getIdOutputCirc(id))) return false;
+    if (!validIdOrig(Est.id_out[id-1])) return false;
   }
   // Tudo valido!
   return true;
@@ -127,8 +322,8 @@ bool Circuito::valid() const
 std::string Circuito::getNamePort(int IdPort) const
 {
   if (IdPort<1 || IdPort>getNumPorts()) throw std::out_of_range("getNamePort: invalid ID");
-  if (ports.at(IdPort-1)==nullptr) return "??";
-  return ports.at(IdPort-1)->getName();
+  if (estr->Nin_port.at(IdPort-1)==0) return "??";
+  return toSigla(estr->tipo_port.at(IdPort-1));
 }
 
 /// Retorna o numero de entradas da porta cuja id eh IdPort.
@@ -136,8 +331,7 @@ std::string Circuito::getNamePort(int IdPort) const
 int Circuito::getNumInputsPort(int IdPort) const
 {
   if (IdPort<1 || IdPort>getNumPorts()) throw std::out_of_range("getNumInputsPort: invalid ID");
-  if (ports.at(IdPort-1)==nullptr) return 0;
-  return ports.at(IdPort-1)->getNumInputs();
+  return estr->Nin_port.at(IdPort-1);
 }
 
 /// Retorna o valor logico atual da saida da porta cuja id eh IdPort.
@@ -145,8 +339,7 @@ int Circuito::getNumInputsPort(int IdPort) const
 bool3S Circuito::getOutputPort(int IdPort) const
 {
   if (IdPort<1 || IdPort>getNumPorts()) throw std::out_of_range("getOutputPort: invalid ID");
-  if (ports.at(IdPort-1)==nullptr) return bool3S::UNDEF;
-  return ports.at(IdPort-1)->getOutput();
+  return estado->valor.at(Nin_circ+IdPort);
 }
 
 /// Retorna o valor logico atual da saida do circuito cuja id eh IdOutput.
@@ -154,7 +347,7 @@ bool3S Circuito::getOutputPort(int IdPort) const
 bool3S Circuito::getOutputCirc(int IdOutput) const
 {
   if (IdOutput<1 || IdOutput>getNumOutputs()) throw std::out_of_range("getOutputCirc: invalid ID");
-  return out_circ.at(IdOutput-1);
+  return estado->out_circ.at(IdOutput-1);
 }
 
 /// Retorna a origem (a id) da I-esima entrada da porta cuja id eh IdPort.
@@ -162,9 +355,9 @@ bool3S Circuito::getOutputCirc(int IdOutput) const
 int Circuito::getIdInPort(int IdPort, int I) const
 {
   if (IdPort<1 || IdPort>getNumPorts()) throw std::out_of_range("getIdInPort: invalid ID");
-  if (ports.at(IdPort-1)==nullptr) throw std::invalid_argument("getIdInPort: port not allocated");
-  if (I<0 || I>=ports.at(IdPort-1)->getNumInputs()) throw std::out_of_range("getIdInPort: invalid index");
-  return id_in.at(IdPort-1).at(I);
+  if (estr->Nin_port.at(IdPort-1)==0) throw std::invalid_argument("getIdInPort: port not allocated");
+  if (I<0 || I>=estr->Nin_port.at(IdPort-1)) throw std::out_of_range("getIdInPort: invalid index");
+  return estr->id_in.at(estr->ini_in.at(IdPort-1)+I);
 }
 
 /// Retorna a origem (a id) da saida do circuito cuja id eh IdOutput.
@@ -172,7 +365,525 @@ int Circuito::getIdInPort(int IdPort, int I) const
 int Circuito::getIdOutputCirc(int IdOutput) const
 {
   if (IdOutput<1 || IdOutput>getNumOutputs()) throw std::out_of_range("getOutputCirc: invalid ID");
-  return id_out.at(IdOutput-1);
+  return estr->id_out.at(IdOutput-1);
+}
+
+/// Retorna o nivel da porta cuja id eh IdPort (-1 se estiver em laco ou depender de laco).
+/// Gera excecao se o parametro for invalido.
+int Circuito::getNivelPort(int IdPort) const
+{
+  if (IdPort<1 || IdPort>getNumPorts()) throw std::out_of_range("getNivelPort: invalid ID");
+  // Com a ordem topologica dinamica valida, basta reparar os niveis das portas alteradas
+  if (estr->din_ok.load(std::memory_order_acquire) && estr->topo_ok.load(std::memory_order_acquire))
+  {
+    atualizarNiveis();
+    return estr->nivel_din.at(IdPort-1);
+  }
+  levelizar();
+  return estr->nivel.at(IdPort-1);
+}
+
+/// Retorna a profundidade do circuito (o maior nivel entre as portas fora de lacos)
+int Circuito::getProfundidade() const
+{
+  levelizar();
+  return estr->Nniveis;
+}
+
+/// Retorna true se o circuito nao tem lacos (realimentacoes)
+bool Circuito::aciclico() const
+{
+  // A ordem topologica dinamica soh eh mantida enquanto o circuito nao tem lacos
+  if (estr->din_ok.load(std::memory_order_acquire) && estr->topo_ok.load(std::memory_order_acquire))
+    return true;
+  levelizar();
+  return estr->Nacicl == getNumPorts();
+}
+
+/// Retorna o numero de entradas de porta alimentadas pela origem IdOrig.
+/// Gera excecao se o parametro for invalido.
+int Circuito::getNumFanout(int IdOrig) const
+{
+  if (!validIdOrig(IdOrig)) throw std::out_of_range("getNumFanout: invalid IdOrig");
+  prepararDinamico();
+  return int(estr->fanout_din[Nin_circ+IdOrig].size());
+}
+
+/// Retorna a id da porta alimentada pela I-esima conexao de saida da origem IdOrig.
+/// Gera excecao se algum parametro for invalido.
+int Circuito::getIdFanout(int IdOrig, int I) const
+{
+  if (!validIdOrig(IdOrig)) throw std::out_of_range("getIdFanout: invalid IdOrig");
+  prepararDinamico();
+  const std::vector<int>& F = estr->fanout_din[Nin_circ+IdOrig];
+  if (I<0 || I>=int(F.size())) throw std::out_of_range("getIdFanout: invalid index");
+  return F[I];
+}
+
+/// Recalcula a ordem de avaliacao e os niveis das portas, se necessario.
+/// Se o circuito nao tem lacos e a ordem topologica dinamica (mantida a cada alteracao) estah
+/// valida, ela eh reaproveitada; senao, a ordem eh calculada do zero.
+void Circuito::levelizar() const
+{
+  if (estr->ordem_ok.load(std::memory_order_acquire)) return;
+  // Varias copias do circuito (p.ex. em threads diferentes) podem compartilhar a mesma estrutura:
+  // apenas uma delas calcula a ordem, e as demais esperam por ela
+  Estrutura& Est = *estr;
+  std::lock_guard<std::mutex> trava(Est.trava_ordem);
+  if (Est.ordem_ok.load(std::memory_order_relaxed)) return;
+
+  if (Est.din_ok.load(std::memory_order_relaxed) && Est.topo_ok.load(std::memory_order_relaxed))
+  {
+    reaproveitarOrdemDinamica();
+  }
+  else
+  {
+    calcularOrdem();
+    calcularDinamico();
+  }
+
+  int NP = getNumPorts();
+  int id, k;
+
+  // O trecho da fila de eventos de cada nivel
+  Est.ini_fila.assign(Est.Nniveis+2, 0);
+  for (id=1; id<=NP; ++id)
+  {
+    if (Est.nivel.at(id-1) > 0) ++Est.ini_fila.at(Est.nivel.at(id-1)+1);
+  }
+  for (k=1; k<=Est.Nniveis+1; ++k) Est.ini_fila.at(k) += Est.ini_fila.at(k-1);
+
+  // Uma nova versao: os estados de simulacao preparados para a ordem anterior sao refeitos
+  Est.versao = ++Nversoes;
+  Est.ordem_ok.store(true, std::memory_order_release);
+}
+
+/// Calcula do zero a ordem de avaliacao, os niveis, o fanout e as componentes fortemente conexas.
+/// Algoritmo de Kahn: uma porta entra na ordem quando todas as portas que alimentam
+/// suas entradas jah entraram. As portas que nunca entram estao em lacos ou dependem deles.
+/// Exige a trava da estrutura.
+void Circuito::calcularOrdem() const
+{
+  Estrutura& Est = *estr;
+  int NP = getNumPorts();
+  int NI = getNumInputs();
+  int id, j, k;
+
+  // Numero de entradas de cada porta que vem de outras portas ainda nao ordenadas
+  std::vector<int> Npend(NP, 0);
+  // Contagem do fanout de cada porta e de cada entrada do circuito
+  Est.ini_fanout.assign(NP+1, 0);
+  Est.ini_fanout_in.assign(NI+1, 0);
+  for (id=1; id<=NP; ++id)
+  {
+    for (j=Est.ini_in.at(id-1); j<Est.ini_in.at(id-1)+Est.Nin_port.at(id-1); ++j)
+    {
+      int orig = Est.id_in.at(j);
+      if (orig>=1 && orig<=NP)
+      {
+        ++Npend.at(id-1);
+        ++Est.ini_fanout.at(orig);
+      }
+      else if (orig<=-1 && orig>=-NI) ++Est.ini_fanout_in.at(-orig);
+    }
+  }
+  for (id=1; id<=NP; ++id) Est.ini_fanout.at(id) += Est.ini_fanout.at(id-1);
+  for (j=1; j<=NI; ++j) Est.ini_fanout_in.at(j) += Est.ini_fanout_in.at(j-1);
+  Est.fanout.resize(Est.ini_fanout.at(NP));
+  Est.fanout_in.resize(Est.ini_fanout_in.at(NI));
+  std::vector<int> pos(Est.ini_fanout.begin(), Est.ini_fanout.end()-1);
+  std::vector<int> pos_in(Est.ini_fanout_in.begin(), Est.ini_fanout_in.end()-1);
+  for (id=1; id<=NP; ++id)
+  {
+    for (j=Est.ini_in.at(id-1); j<Est.ini_in.at(id-1)+Est.Nin_port.at(id-1); ++j)
+    {
+      int orig = Est.id_in.at(j);
+      if (orig>=1 && orig<=NP) Est.fanout.at(pos.at(orig-1)++) = id;
+      else if (orig<=-1 && orig>=-NI) Est.fanout_in.at(pos_in.at(-orig-1)++) = id;
+    }
+  }
+
+  Est.ordem.clear();
+  Est.ordem.reserve(NP);
+  Est.nivel.assign(NP, -1);
+
+  // Inicialmente, as portas que soh dependem de entradas do circuito
+  for (id=1; id<=NP; ++id)
+  {
+    if (Npend.at(id-1) == 0)
+    {
+      Est.ordem.push_back(id);
+      Est.nivel.at(id-1) = 1;
+    }
+  }
+  // O proprio vetor "ordem" funciona como fila
+  for (k=0; k<int(Est.ordem.size()); ++k)
+  {
+    id = Est.ordem.at(k);
+    for (j=Est.ini_fanout.at(id-1); j<Est.ini_fanout.at(id); ++j)
+    {
+      int dest = Est.fanout.at(j);
+      if (Est.nivel.at(dest-1) < Est.nivel.at(id-1)+1) Est.nivel.at(dest-1) = Est.nivel.at(id-1)+1;
+      if (--Npend.at(dest-1) == 0) Est.ordem.push_back(dest);
+    }
+  }
+  Est.Nacicl = int(Est.ordem.size());
+  Est.Nniveis = 0;
+  for (k=0; k<Est.Nacicl; ++k)
+  {
+    if (Est.nivel.at(Est.ordem.at(k)-1) > Est.Nniveis) Est.Nniveis = Est.nivel.at(Est.ordem.at(k)-1);
+  }
+
+  // As portas restantes estao em lacos ou dependem deles
+  for (id=1; id<=NP; ++id)
+  {
+    if (Npend.at(id-1) > 0) Est.nivel.at(id-1) = -1;
+  }
+
+  // Componentes fortemente conexas das portas restantes (algoritmo de Tarjan, iterativo),
+  // seguindo as arestas de cada porta para as origens de suas entradas que tambem estao
+  // entre as portas restantes. O algoritmo termina cada componente depois de todas
+  // as componentes das quais ela depende, entao as componentes sao acrescentadas a "ordem"
+  // na ordem em que devem ser avaliadas.
+  Est.comp.assign(NP, -1);
+  Est.ini_comp.clear();
+  std::vector<int> indice(NP, -1);
+  std::vector<int> menor(NP, 0);
+  std::vector<char> empilhada(NP, 0);
+  std::vector<int> pilha;
+  // A pilha de chamadas: a porta e a posicao em id_in da proxima entrada a ser visitada
+  std::vector< std::pair<int,int> > chamadas;
+  int Nvisitadas = 0;
+  for (id=1; id<=NP; ++id)
+  {
+    if (Est.nivel.at(id-1)!=-1 || indice.at(id-1)!=-1) continue;
+    indice.at(id-1) = menor.at(id-1) = Nvisitadas++;
+    pilha.push_back(id);
+    empilhada.at(id-1) = 1;
+    chamadas.push_back(std::make_pair(id, Est.ini_in.at(id-1)));
+    while (!chamadas.empty())
+    {
+      int v = chamadas.back().first;
+      j = chamadas.back().second;
+      if (j < Est.ini_in.at(v-1)+Est.Nin_port.at(v-1))
+      {
+        ++chamadas.back().second;
+        int w = Est.id_in.at(j);
+        // As origens fora das portas restantes jah tem seu valor final
+        if (w<1 || w>NP || Est.nivel.at(w-1)!=-1) continue;
+        if (indice.at(w-1) == -1)
+        {
+          indice.at(w-1) = menor.at(w-1) = Nvisitadas++;
+          pilha.push_back(w);
+          empilhada.at(w-1) = 1;
+          chamadas.push_back(std::make_pair(w, Est.ini_in.at(w-1)));
+        }
+        else if (empilhada.at(w-1))
+        {
+          menor.at(v-1) = std::min(menor.at(v-1), indice.at(w-1));
+        }
+      }
+      else
+      {
+        chamadas.pop_back();
+        if (!chamadas.empty())
+        {
+          int u = chamadas.back().first;
+          menor.at(u-1) = std::min(menor.at(u-1), menor.at(v-1));
+        }
+        // v eh a raiz de uma componente: desempilha todas as suas portas
+        if (menor.at(v-1) == indice.at(v-1))
+        {
+          int c = int(Est.ini_comp.size());
+          Est.ini_comp.push_back(int(Est.ordem.size()));
+          int w;
+          do
+          {
+            w = pilha.back();
+            pilha.pop_back();
+            empilhada.at(w-1) = 0;
+            Est.comp.at(w-1) = c;
+            Est.ordem.push_back(w);
+          } while (w != v);
+        }
+      }
+    }
+  }
+  Est.ini_comp.push_back(int(Est.ordem.size()));
+}
+
+/// ***********************
+/// Indice de fanout e ordem topologica dinamicos
+/// ***********************
+
+/// Calcula o indice de fanout dinamico (se ainda nao existir) a partir do fanout compacto
+/// recem-calculado e, se o circuito nao tem lacos, a ordem topologica dinamica a partir da
+/// ordem de avaliacao. Exige a trava da estrutura.
+void Circuito::calcularDinamico() const
+{
+  Estrutura& Est = *estr;
+  int NP = getNumPorts();
+  int NI = getNumInputs();
+  int id, i, k;
+
+  if (!Est.din_ok.load(std::memory_order_relaxed))
+  {
+    // fanout_din.at(NI+IdOrig): a entrada -(i+1) do circuito fica na posicao NI-i-1
+    Est.fanout_din.assign(NI+1+NP, std::vector<int>());
+    for (i=0; i<NI; ++i)
+    {
+      Est.fanout_din.at(NI-i-1).assign(Est.fanout_in.begin()+Est.ini_fanout_in.at(i),
+                                        Est.fanout_in.begin()+Est.ini_fanout_in.at(i+1));
+    }
+    for (id=1; id<=NP; ++id)
+    {
+      Est.fanout_din.at(NI+id).assign(Est.fanout.begin()+Est.ini_fanout.at(id-1),
+                                      Est.fanout.begin()+Est.ini_fanout.at(id));
+    }
+    Est.marca_din.assign(NP, 0);
+    Est.pendente_din.assign(NP, 0);
+    Est.pend_din.clear();
+  }
+  // Com lacos, nao ha ordem topologica a manter
+  bool topo = (Est.Nacicl == NP);
+  if (topo)
+  {
+    Est.ordem_din = Est.ordem;
+    Est.pos_din.resize(NP);
+    for (k=0; k<NP; ++k) Est.pos_din.at(Est.ordem_din.at(k)-1) = k;
+    Est.nivel_din = Est.nivel;
+    for (k=0; k<int(Est.pend_din.size()); ++k) Est.pendente_din.at(Est.pend_din[k]-1) = 0;
+    Est.pend_din.clear();
+    Est.niveis_ok.store(true, std::memory_order_release);
+  }
+  Est.topo_ok.store(topo, std::memory_order_release);
+  Est.din_ok.store(true, std::memory_order_release);
+}
+
+/// Usa a ordem topologica dinamica (circuito sem lacos) como ordem de avaliacao: os niveis jah
+/// estao atualizados e o fanout compacto eh copiado do indice dinamico, sem os algoritmos de
+/// Kahn e de Tarjan. Exige a trava da estrutura.
+void Circuito::reaproveitarOrdemDinamica() const
+{
+  Estrutura& Est = *estr;
+  int NP = getNumPorts();
+  int NI = getNumInputs();
+  int id, i;
+
+  if (!Est.niveis_ok.load(std::memory_order_relaxed)) repararNiveis();
+  Est.ordem = Est.ordem_din;
+  Est.nivel = Est.nivel_din;
+  Est.Nacicl = NP;
+  Est.Nniveis = 0;
+  for (id=1; id<=NP; ++id)
+  {
+    if (Est.nivel.at(id-1) > Est.Nniveis) Est.Nniveis = Est.nivel.at(id-1);
+  }
+  // Sem lacos, nenhuma porta pertence a uma componente fortemente conexa
+  Est.comp.assign(NP, -1);
+  Est.ini_comp.assign(1, NP);
+
+  // O fanout compacto de cada porta e de cada entrada do circuito
+  Est.ini_fanout.resize(NP+1);
+  Est.ini_fanout.at(0) = 0;
+  for (id=1; id<=NP; ++id)
+  {
+    Est.ini_fanout.at(id) = Est.ini_fanout.at(id-1)+int(Est.fanout_din.at(NI+id).size());
+  }
+  Est.fanout.resize(Est.ini_fanout.at(NP));
+  for (id=1; id<=NP; ++id)
+  {
+    std::copy(Est.fanout_din.at(NI+id).begin(), Est.fanout_din.at(NI+id).end(),
+              Est.fanout.begin()+Est.ini_fanout.at(id-1));
+  }
+  Est.ini_fanout_in.resize(NI+1);
+  Est.ini_fanout_in.at(0) = 0;
+  for (i=0; i<NI; ++i)
+  {
+    Est.ini_fanout_in.at(i+1) = Est.ini_fanout_in.at(i)+int(Est.fanout_din.at(NI-i-1).size());
+  }
+  Est.fanout_in.resize(Est.ini_fanout_in.at(NI));
+  for (i=0; i<NI; ++i)
+  {
+    std::copy(Est.fanout_din.at(NI-i-1).begin(), Est.fanout_din.at(NI-i-1).end(),
+              Est.fanout_in.begin()+Est.ini_fanout_in.at(i));
+  }
+}
+
+/// Retira do indice de fanout uma conexao da origem IdOrig para a porta IdPort.
+/// A busca comeca pelo fim, onde ficam as conexoes acrescentadas por ultimo (as portas alteradas
+/// recentemente costumam ser alteradas de novo).
+/// Retirar uma conexao nunca invalida a ordem topologica (os niveis sao reparados depois).
+void Circuito::removerConexao(int IdOrig, int IdPort)
+{
+  if (IdOrig == 0) return;
+  std::vector<int>& F = estr->fanout_din.at(Nin_circ+IdOrig);
+  int k = int(F.size())-1;
+  while (F.at(k) != IdPort) --k;
+  F.at(k) = F.back();
+  F.pop_back();
+}
+
+/// Acrescenta ao indice de fanout uma conexao da origem IdOrig para a porta IdPort e, se
+/// IdOrig estiver depois de IdPort na ordem topologica dinamica, repara a ordem localmente
+/// (algoritmo de Pearce e Kelly): apenas as portas entre as posicoes de IdPort e de IdOrig que
+/// dependem de IdPort, ou das quais IdOrig depende, trocam de posicao entre si.
+/// Se a conexao fechar um laco, a ordem dinamica deixa de ser mantida.
+void Circuito::inserirConexao(int IdOrig, int IdPort)
+{
+  if (IdOrig == 0) return;
+  Estrutura& Est = *estr;
+  Est.fanout_din.at(Nin_circ+IdOrig).push_back(IdPort);
+  // Uma entrada do circuito nao muda a ordem das portas
+  if (IdOrig < 0 || !Est.topo_ok.load(std::memory_order_relaxed)) return;
+  int lb = Est.pos_din.at(IdPort-1);
+  int ub = Est.pos_din.at(IdOrig-1);
+  if (ub < lb) return;
+
+  std::vector<int>& frente = Est.frente_din;
+  std::vector<int>& tras = Est.tras_din;
+  std::vector<char>& marca = Est.marca_din;
+  size_t k;
+  int j;
+
+  // Busca para frente, a partir de IdPort, entre as portas ateh a posicao de IdOrig:
+  // se IdOrig for alcancada, a nova conexao fecha um laco
+  bool laco = false;
+  frente.assign(1, IdPort);
+  marca.at(IdPort-1) = 1;
+  for (k=0; k<frente.size() && !laco; ++k)
+  {
+    const std::vector<int>& F = Est.fanout_din.at(Nin_circ+frente[k]);
+    for (j=0; j<int(F.size()) && !laco; ++j)
+    {
+      int dest = F[j];
+      if (dest == IdOrig) laco = true;
+      else if (!marca.at(dest-1) && Est.pos_din.at(dest-1) <= ub)
+      {
+        marca.at(dest-1) = 1;
+        frente.push_back(dest);
+      }
+    }
+  }
+  if (laco)
+  {
+    for (k=0; k<frente.size(); ++k) marca.at(frente[k]-1) = 0;
+    Est.topo_ok = false;
+    return;
+  }
+
+  // Busca para tras, a partir de IdOrig, entre as portas a partir da posicao de IdPort
+  tras.assign(1, IdOrig);
+  marca.at(IdOrig-1) = 1;
+  for (k=0; k<tras.size(); ++k)
+  {
+    int id = tras[k];
+    for (j=Est.ini_in.at(id-1); j<Est.ini_in.at(id-1)+Est.Nin_port.at(id-1); ++j)
+    {
+      int orig = Est.id_in.at(j);
+      if (orig > 0 && !marca.at(orig-1) && Est.pos_din.at(orig-1) >= lb)
+      {
+        marca.at(orig-1) = 1;
+        tras.push_back(orig);
+      }
+    }
+  }
+
+  // As portas encontradas ocupam as mesmas posicoes de antes: primeiro as que alimentam
+  // IdOrig, depois as alimentadas por IdPort, cada grupo na sua ordem relativa anterior
+  auto antes = [&Est](int a, int b) { return Est.pos_din[a-1] < Est.pos_din[b-1]; };
+  std::sort(tras.begin(), tras.end(), antes);
+  std::sort(frente.begin(), frente.end(), antes);
+  std::vector<int>& pos = Est.pos_aux_din;
+  pos.clear();
+  for (k=0; k<tras.size(); ++k) pos.push_back(Est.pos_din.at(tras[k]-1));
+  for (k=0; k<frente.size(); ++k) pos.push_back(Est.pos_din.at(frente[k]-1));
+  std::sort(pos.begin(), pos.end());
+  size_t p = 0;
+  for (k=0; k<tras.size(); ++k, ++p)
+  {
+    Est.ordem_din.at(pos[p]) = tras[k];
+    Est.pos_din.at(tras[k]-1) = pos[p];
+    marca.at(tras[k]-1) = 0;
+  }
+  for (k=0; k<frente.size(); ++k, ++p)
+  {
+    Est.ordem_din.at(pos[p]) = frente[k];
+    Est.pos_din.at(frente[k]-1) = pos[p];
+    marca.at(frente[k]-1) = 0;
+  }
+}
+
+/// Marca a porta IdPort para ter o seu nivel dinamico recalculado na proxima consulta.
+/// Varias alteracoes seguidas das mesmas portas sao reparadas de uma soh vez.
+void Circuito::marcarNivel(int IdPort)
+{
+  Estrutura& Est = *estr;
+  if (!Est.pendente_din.at(IdPort-1))
+  {
+    Est.pendente_din.at(IdPort-1) = 1;
+    Est.pend_din.push_back(IdPort);
+  }
+  Est.niveis_ok.store(false, std::memory_order_relaxed);
+}
+
+/// Recalcula os niveis das portas marcadas a partir das origens de suas entradas e propaga as
+/// mudancas para as portas alimentadas por elas, em ordem topologica (com um heap de posicoes):
+/// soh sao visitadas as portas marcadas e aquelas cujas origens mudaram de nivel.
+/// Exige a trava da estrutura e que a ordem topologica dinamica esteja valida.
+void Circuito::repararNiveis() const
+{
+  Estrutura& Est = *estr;
+  std::vector<int>& heap = Est.heap_din;
+  heap.clear();
+  for (size_t k=0; k<Est.pend_din.size(); ++k)
+  {
+    Est.pendente_din.at(Est.pend_din[k]-1) = 0;
+    heap.push_back(Est.pos_din.at(Est.pend_din[k]-1));
+  }
+  Est.pend_din.clear();
+  std::make_heap(heap.begin(), heap.end(), std::greater<int>());
+  int anterior = -1;
+  while (!heap.empty())
+  {
+    std::pop_heap(heap.begin(), heap.end(), std::greater<int>());
+    int p = heap.back();
+    heap.pop_back();
+    // Uma porta pode ter sido colocada no heap mais de uma vez
+    if (p == anterior) continue;
+    anterior = p;
+    int id = Est.ordem_din.at(p);
+    int n = 0;
+    for (int j=Est.ini_in.at(id-1); j<Est.ini_in.at(id-1)+Est.Nin_port.at(id-1); ++j)
+    {
+      int orig = Est.id_in.at(j);
+      if (orig > 0 && Est.nivel_din.at(orig-1) > n) n = Est.nivel_din.at(orig-1);
+    }
+    if (n+1 == Est.nivel_din.at(id-1)) continue;
+    Est.nivel_din.at(id-1) = n+1;
+    const std::vector<int>& F = Est.fanout_din.at(Nin_circ+id);
+    for (size_t k=0; k<F.size(); ++k)
+    {
+      heap.push_back(Est.pos_din.at(F[k]-1));
+      std::push_heap(heap.begin(), heap.end(), std::greater<int>());
+    }
+  }
+  Est.niveis_ok.store(true, std::memory_order_release);
+}
+
+/// Repara os niveis dinamicos, se necessario
+void Circuito::atualizarNiveis() const
+{
+  if (estr->niveis_ok.load(std::memory_order_acquire)) return;
+  std::lock_guard<std::mutex> trava(estr->trava_ordem);
+  if (!estr->niveis_ok.load(std::memory_order_relaxed)) repararNiveis();
+}
+
+/// Garante que o indice de fanout dinamico estah calculado
+void Circuito::prepararDinamico() const
+{
+  // Uma ordem de avaliacao calculada implica o indice calculado
+  if (!estr->din_ok.load(std::memory_order_acquire)) levelizar();
 }
 
 /// ***********************
@@ -195,22 +906,58 @@ void Circuito::setPort(int IdPort, const std::string& Tipo, int Nin)
        (Tipo!="NT" && Nin<2) ) throw std::range_error("setPort: invalid number of inputs");
 
   // Altera a porta:
-  // - cria a nova porta
-  // - redimensiona o vetor de conexoes da porta
-  Porta* novaPorta = nullptr;
-
-  if (Tipo == "NT") novaPorta = new PortaNOT();
-  else if (Tipo == "AN") novaPorta = new PortaAND(Nin);
-  else if (Tipo == "NA") novaPorta = new PortaNAND(Nin);
-  else if (Tipo == "OR") novaPorta = new PortaOR(Nin);
-  else if (Tipo == "NO") novaPorta = new PortaNOR(Nin);
-  else if (Tipo == "XO") novaPorta = new PortaXOR(Nin);
-  else if (Tipo == "NX") novaPorta = new PortaNXOR(Nin);
-
-  ports.at(IdPort - 1) = novaPorta;
+  // - fixa o novo tipo
+  // - redimensiona o trecho de id_in com as conexoes da porta: se a porta estah no fim de id_in,
+  //   o trecho aumenta ou diminui no proprio lugar; senao, se a porta passou a ter mais entradas,
+  //   as conexoes sao copiadas para o fim de id_in (e, depois disso, a porta estah no fim:
+  //   novas alteracoes da mesma porta nao abandonam mais nenhum espaco)
+  // A estrutura deixa de ser compartilhada com outras copias do circuito
+  separarEstrutura();
+  Estrutura& Est = *estr;
+  int i = IdPort-1;
+  int ini = Est.ini_in.at(i);
+  int Nant = Est.Nin_port.at(i);
+  bool din = Est.din_ok.load(std::memory_order_relaxed);
+  // As conexoes das entradas que deixam de existir saem do indice de fanout
+  // (as novas entradas comecam indefinidas)
+  if (din)
+  {
+    for (int j=Nin; j<Nant; ++j) removerConexao(Est.id_in.at(ini+j), IdPort);
+  }
+  Est.tipo_port.at(i) = toTipoPorta(Tipo);
+  if (ini+Nant == int(Est.id_in.size()))
+  {
+    // A porta estah no fim de id_in: basta redimensionar o vetor
+    Est.id_in.resize(ini+Nin, 0);
+  }
+  else if (Nin <= Nant)
+  {
+    // As posicoes que sobram no fim do trecho ficam abandonadas
+    Est.Nlixo += Nant-Nin;
+  }
+  else
+  {
+    // O trecho antigo fica abandonado
+    int novo = int(Est.id_in.size());
+    Est.id_in.resize(novo+Nin, 0);
+    std::copy(Est.id_in.begin()+ini, Est.id_in.begin()+ini+Nant, Est.id_in.begin()+novo);
+    Est.ini_in.at(i) = novo;
+    Est.Nlixo += Nant;
+  }
+  Est.Nin_port.at(i) = Nin;
+  separarEstado();
+  estado->valor.at(Nin_circ+IdPort) = bool3S::UNDEF;
+  // Se houver muito espaco abandonado, compacta
+  if (Est.Nlixo > int(Est.id_in.size())/2) compactar();
+  // O nivel desta porta (e das que dependem dela) serah reparado na proxima consulta
+  if (din && Nin < Nant && Est.topo_ok.load(std::memory_order_relaxed)) marcarNivel(IdPort);
 
-  id_in.at(IdPort - 1).resize(Nin, 0);
-  // perguntar pra ele
+  // A ordem de avaliacao das portas deve ser recalculada (com uma nova versao, os estados
+  // de simulacao sao preparados de novo)
+  Est.ordem_ok = false;
+  cone_ok = false;
+  demanda_ok = false;
+  invalidarCache();
 }
 
 /// Altera a origem de uma entrada de uma porta
@@ -218,11 +965,29 @@ void Circuito::setIdInPort(int IdPort, int I, int IdOrig)
 {
   // Chegagem dos parametros
   if (IdPort<1 || IdPort>getNumPorts()) throw std::out_of_range("setIdInPort: invalid IdPort");
-  if (ports.at(IdPort-1)==nullptr) throw std::invalid_argument("setIdInPort: port not allocated");
-  if (I<0 || I>=ports.at(IdPort-1)->getNumInputs()) throw std::out_of_range("setIdInPort: invalid index");
+  if (estr->Nin_port.at(IdPort-1)==0) throw std::invalid_argument("setIdInPort: port not allocated");
+  if (I<0 || I>=estr->Nin_port.at(IdPort-1)) throw std::out_of_range("setIdInPort: invalid index");
   if (!validIdOrig(IdOrig)) throw std::out_of_range("setIdInPort: invalid IdOrig");
-  // Fixa a origem da entrada
-  id_in.at(IdPort-1).at(I) = IdOrig;
+  // Fixa a origem da entrada (a estrutura deixa de ser compartilhada com outras copias)
+  separarEstrutura();
+  Estrutura& Est = *estr;
+  int& orig = Est.id_in.at(Est.ini_in.at(IdPort-1)+I);
+  if (orig == IdOrig) return;
+  if (Est.din_ok.load(std::memory_order_relaxed))
+  {
+    // O indice de fanout e a ordem topologica dinamicos sao reparados localmente (e os niveis,
+    // na proxima consulta)
+    removerConexao(orig, IdPort);
+    orig = IdOrig;
+    inserirConexao(IdOrig, IdPort);
+    if (Est.topo_ok.load(std::memory_order_relaxed)) marcarNivel(IdPort);
+  }
+  else orig = IdOrig;
+  // A ordem de avaliacao das portas deve ser recalculada
+  Est.ordem_ok = false;
+  cone_ok = false;
+  demanda_ok = false;
+  invalidarCache();
 }
 
 /// Altera a origem de uma saida
@@ -230,7 +995,11 @@ void Circuito::setIdOutputCirc(int IdOutput, int IdOrig)
 {
   if (IdOutput<1 || IdOutput>getNumOutputs()) throw std::out_of_range("setIdOutputCirc: invalid IdOutput");
   if (!validIdOrig(IdOrig)) throw std::out_of_range("setIdOutputCirc: invalid IdOrig");
-  id_out.at(IdOutput-1) = IdOrig;
+  separarEstrutura();
+  estr->id_out.at(IdOutput-1) = IdOrig;
+  // O cone de influencia das saidas deve ser recalculado
+  cone_ok = false;
+  invalidarCache();
 }
 
 /// ***********************
@@ -369,52 +1138,659 @@ void Circuito::salvar(const std::string& arq) const
 /// SIMULACAO (funcao principal do circuito)
 /// ***********************
 
+/// Prepara o estado E para a ordem de avaliacao atual: redimensiona os vetores de trabalho
+/// (os valores dos sinais sao mantidos, se o numero de sinais nao mudou) e esvazia a fila de eventos.
+/// O estado so fica apto para simulacao incremental depois de uma simulacao completa.
+void Circuito::prepararEstado(EstadoSimulacao& E) const
+{
+  const Estrutura& Est = *estr;
+  if (E.versao == Est.versao) return;
+  E.Nin_circ = Nin_circ;
+  E.valor.resize(Nin_circ+1+getNumPorts(), bool3S::UNDEF);
+  E.valor[Nin_circ] = bool3S::UNDEF;
+  E.out_circ.resize(getNumOutputs(), bool3S::UNDEF);
+  E.estado_ok = false;
+  E.lista_comp.resize(getNumPorts()-Est.Nacicl);
+  E.na_lista_comp.assign(getNumPorts(), 0);
+  E.fila.resize(Est.ini_fila[Est.Nniveis+1]);
+  E.fim_fila.assign(Est.ini_fila.begin(), Est.ini_fila.end()-1);
+  E.agendada.assign(getNumPorts(), 0);
+  E.alteradas.clear();
+  // Depois desta reserva, atualizarSaidas nao faz mais nenhuma alocacao
+  E.alteradas.reserve(getNumOutputs());
+  E.versao = Est.versao;
+}
+
+/// Simula as portas em lacos (ou que dependem deles), que devem estar todas indefinidas,
+/// uma componente fortemente conexa de cada vez: dentro de cada componente, reavalia apenas
+/// as portas cujas entradas mudaram, ateh nao haver mais mudanca.
+/// Como as operacoes de bool3S sao monotonas, o resultado eh o mesmo de repetir a avaliacao
+/// de todas as portas indefinidas ateh nenhuma mudar: as portas que continuam
+/// indefinidas ao final ficam com saida bool3S::UNDEF.
+void Circuito::simularLacos(EstadoSimulacao& E) const
+{
+  // As componentes fortemente conexas, em ordem topologica: as entradas de cada componente
+  // que vem de fora dela jah tem seu valor final quando ela eh avaliada
+  for (int c = 0; c+1 < int(estr->ini_comp.size()); ++c) {
+      simularComponente(c, E);
+  }
+}
+
+/// Simula as portas da componente fortemente conexa c, partindo de todas indefinidas,
+/// ateh nenhuma mudar
+void Circuito::simularComponente(int c, EstadoSimulacao& E) const
+{
+  const Estrutura& Est = *estr;
+  int ini = Est.ini_comp[c];
+  int Nc = Est.ini_comp[c+1]-ini;
+  bool3S* V = E.valor.data() + Nin_circ;
+  int* lista = E.lista_comp.data();
+  char* na_lista = E.na_lista_comp.data();
+
+  // Lista de trabalho circular em lista[0..Nc-1], inicialmente com todas as portas
+  // da componente. Cada porta estah no maximo uma vez na lista.
+  int cabeca = 0;
+  int Nlista = Nc;
+  for (int k = 0; k < Nc; ++k) {
+      lista[k] = Est.ordem[ini+k];
+      na_lista[Est.ordem[ini+k]-1] = 1;
+  }
+  while (Nlista > 0) {
+      int id = lista[cabeca];
+      cabeca = (cabeca+1 == Nc ? 0 : cabeca+1);
+      --Nlista;
+      na_lista[id-1] = 0;
+
+      bool3S S = simularPorta(id, V);
+      if (S != V[id]) {
+          V[id] = S;
+          // Reavalia as portas da mesma componente alimentadas por essa porta
+          for (int j = Est.ini_fanout[id-1]; j < Est.ini_fanout[id]; ++j) {
+              int dest = Est.fanout[j];
+              if (Est.comp[dest-1] == c && !na_lista[dest-1]) {
+                  na_lista[dest-1] = 1;
+                  int pos = cabeca+Nlista;
+                  lista[pos >= Nc ? pos-Nc : pos] = dest;
+                  ++Nlista;
+              }
+          }
+      }
+  }
+}
+
+/// Retorna a saida da porta cuja id eh IdPort, calculada com os valores dos sinais V
+bool3S Circuito::simularPorta(int IdPort, const bool3S* V) const
+{
+  const Estrutura& Est = *estr;
+  const int* in = Est.id_in.data() + Est.ini_in[IdPort-1];
+  int Nin = Est.Nin_port[IdPort-1];
+  bool3S res = V[in[0]];
+  int j;
+
+  switch (Est.tipo_port[IdPort-1]) {
+  case TipoPorta::NT:
+      return ~res;
+  case TipoPorta::AN:
+      for (j = 1; j < Nin; ++j) res = res & V[in[j]];
+      return res;
+  case TipoPorta::NA:
+      for (j = 1; j < Nin; ++j) res = res & V[in[j]];
+      return ~res;
+  case TipoPorta::OR:
+      for (j = 1; j < Nin; ++j) res = res | V[in[j]];
+      return res;
+  case TipoPorta::NO:
+      for (j = 1; j < Nin; ++j) res = res | V[in[j]];
+      return ~res;
+  case TipoPorta::XO:
+      for (j = 1; j < Nin; ++j) res = res ^ V[in[j]];
+      return res;
+  case TipoPorta::NX:
+  default:
+      for (j = 1; j < Nin; ++j) res = res ^ V[in[j]];
+      return ~res;
+  }
+}
+
 /// Calcula as saidas do circuito para os valores de entrada passados como parametro,
 /// caso o circuito e o parametro de entrada sejam validos.
 /// Se o circuito ou o parametro forem invalidos, gera excecao.
 void Circuito::simular(const std::vector<bool3S>& in_circ)
 {
-  // Soh simula se o cicuito e o parametro forem validos
-  if (!valid()) throw std::logic_error("simular: invalid circuit");
   if (static_cast<int>(in_circ.size()) != getNumInputs())
     throw std::range_error("simular: incompatible parameter size");
 
-  for (int i = 0; i < getNumPorts(); ++i) {
-      ports.at(i)->setOutput(bool3S::UNDEF);
+  // Consulta ao cache de resultados. Como o cache eh esvaziado a cada modificacao do circuito,
+  // um resultado encontrado foi calculado para este mesmo circuito, que jah foi validado.
+  if (cache_max > 0)
+  {
+    empacotar(in_circ.data(), getNumInputs(), chave_cache);
+    auto it = cache_mapa.find(chave_cache);
+    if (it != cache_mapa.end())
+    {
+      ++cache_acertos;
+      // O resultado passa a ser o mais recentemente usado
+      cache_lru.splice(cache_lru.begin(), cache_lru, it->second);
+      const std::string& pac = it->second->second;
+      separarEstado();
+      estado->alteradas.clear();
+      for (int id = 1; id <= getNumOutputs(); ++id) {
+          bool3S S = desempacotar(pac, id-1);
+          if (S != estado->out_circ[id-1]) {
+              estado->out_circ[id-1] = S;
+              estado->alteradas.push_back(id);
+          }
+      }
+      // Os valores das portas nao correspondem a este vetor de entrada
+      estado->estado_ok = false;
+      return;
+    }
+    ++cache_falhas;
+  }
+
+  // Soh simula se o cicuito for valido
+  if (!valid()) throw std::logic_error("simular: invalid circuit");
+
+  levelizar();
+  separarEstado();
+  prepararEstado(*estado);
+  simularVetor(in_circ.data(), *estado);
+  atualizarSaidas(*estado);
+
+  if (cache_max > 0) guardarCache();
+}
+
+/// Guarda no cache as saidas atuais do circuito para o vetor de entrada em chave_cache,
+/// descartando os resultados usados ha mais tempo se o orcamento for excedido
+void Circuito::guardarCache()
+{
+  std::string pac;
+  empacotar(estado->out_circ.data(), getNumOutputs(), pac);
+  // Estimativa da memoria usada: a entrada empacotada (guardada na lista e no indice),
+  // a saida empacotada e os nos da lista e do indice
+  size_t bytes = 2*chave_cache.size() + pac.size() + CUSTO_RESULTADO_CACHE;
+  if (bytes > cache_max) return;
+  while (cache_bytes+bytes > cache_max)
+  {
+    const auto& ultimo = cache_lru.back();
+    cache_bytes -= 2*ultimo.first.size() + ultimo.second.size() + CUSTO_RESULTADO_CACHE;
+    cache_mapa.erase(ultimo.first);
+    cache_lru.pop_back();
+  }
+  cache_lru.push_front(std::make_pair(chave_cache, std::move(pac)));
+  cache_mapa[chave_cache] = cache_lru.begin();
+  cache_bytes += bytes;
+}
+
+/// Ativa o cache de resultados, com um orcamento de MaxBytes bytes (0 desativa o cache)
+void Circuito::setCacheResultados(size_t MaxBytes)
+{
+  invalidarCache();
+  cache_max = MaxBytes;
+  cache_acertos = cache_falhas = 0;
+}
+
+/// Simula um lote de Nvetores vetores de entrada, armazenados um apos o outro em in_lote.
+/// As saidas de cada vetor sao escritas, na mesma ordem, em out_lote.
+/// A validacao do circuito e o calculo da ordem de avaliacao sao feitos uma unica vez por lote.
+void Circuito::simularLote(const bool3S* in_lote, int Nvetores, bool3S* out_lote)
+{
+  if (!valid()) throw std::logic_error("simularLote: invalid circuit");
+  if (Nvetores < 0 || (Nvetores > 0 && (in_lote == nullptr || out_lote == nullptr)))
+    throw std::invalid_argument("simularLote: invalid parameter(s)");
+  if (Nvetores == 0) return;
+
+  levelizar();
+  separarEstado();
+  prepararEstado(*estado);
+  executarLote(in_lote, Nvetores, out_lote, false, *estado);
+}
+
+/// Simula um lote de vetores de entrada (in_lote.size()/getNumInputs() vetores).
+/// Redimensiona out_lote para receber as saidas de todos os vetores.
+void Circuito::simularLote(const std::vector<bool3S>& in_lote, std::vector<bool3S>& out_lote)
+{
+  if (getNumInputs() <= 0) throw std::logic_error("simularLote: invalid circuit");
+  if (in_lote.size() % getNumInputs() != 0)
+    throw std::range_error("simularLote: incompatible parameter size");
+  int Nvetores = static_cast<int>(in_lote.size()) / getNumInputs();
+  out_lote.resize(size_t(Nvetores)*getNumOutputs());
+  simularLote(in_lote.data(), Nvetores, out_lote.data());
+}
+
+/// Simula os Nvetores vetores de in_lote, escrevendo as saidas de cada um em out_lote.
+/// Se Incremental == true, cada vetor parte do estado deixado pelo anterior.
+void Circuito::executarLote(const bool3S* in_lote, int Nvetores, bool3S* out_lote,
+                            bool Incremental, EstadoSimulacao& E) const
+{
+  const Estrutura& Est = *estr;
+  const int NI = getNumInputs();
+  const int NO = getNumOutputs();
+  const bool3S* V = E.valor.data() + Nin_circ;
+  const int* orig = Est.id_out.data();
+  for (int v = 0; v < Nvetores; ++v) {
+      // Sem estado anterior valido, o vetor eh simulado por completo
+      if (Incremental && E.estado_ok) propagarEventos(in_lote + v*NI, E);
+      else simularVetor(in_lote + v*NI, E);
+      bool3S* out = out_lote + v*NO;
+      for (int id = 0; id < NO; ++id) out[id] = V[orig[id]];
+  }
+
+  // O estado fica com as saidas do ultimo vetor do lote
+  atualizarSaidas(E);
+}
+
+/// Calcula os valores de todas as portas para o vetor de entrada in_circ,
+/// sem nenhuma checagem. Exige que a ordem de avaliacao esteja atualizada.
+void Circuito::simularVetor(const bool3S* in_circ, EstadoSimulacao& E) const
+{
+  const Estrutura& Est = *estr;
+  bool3S* V = E.valor.data() + Nin_circ;
+
+  // Entradas do circuito (a entrada id=-(i+1) fica em V[-i-1])
+  for (int i = 0; i < getNumInputs(); ++i) {
+      V[-i-1] = in_circ[i];
   }
 
-  bool tudo_def, alguma_def;
+  // Portas fora de lacos: uma unica avaliacao de cada, em ordem topologica
+  // (cada porta soh depende de entradas ou de portas avaliadas antes dela)
+  for (int k = 0; k < Est.Nacicl; ++k) {
+      V[Est.ordem[k]] = simularPorta(Est.ordem[k], V);
+  }
 
-  do {
-      tudo_def = true;
-      alguma_def = false;
+  // Portas em lacos (ou que dependem deles): comecam indefinidas e
+  // sao repetidamente avaliadas ateh nao haver mais mudanca
+  for (int k = Est.Nacicl; k < getNumPorts(); ++k) {
+      V[Est.ordem[k]] = bool3S::UNDEF;
+  }
+  simularLacos(E);
 
-      for (int id = 1; id <= getNumPorts(); ++id) {
-          if (getOutputPort(id) == bool3S::UNDEF) {
+  // O estado pode ser usado pela proxima simulacao incremental
+  E.estado_ok = true;
+}
 
-              std::vector<bool3S> in_port(getNumInputsPort(id));
+/// Simulacao incremental (orientada a eventos).
+/// Reavalia apenas as portas alimentadas pelas entradas que mudaram, em ordem crescente de nivel.
+/// Retorna as ids das saidas do circuito cujo valor mudou.
+const std::vector<int>& Circuito::simularIncremental(const std::vector<bool3S>& in_circ)
+{
+  // Soh simula se o cicuito e o parametro forem validos
+  if (!valid()) throw std::logic_error("simularIncremental: invalid circuit");
+  if (static_cast<int>(in_circ.size()) != getNumInputs())
+    throw std::range_error("simularIncremental: incompatible parameter size");
 
-              for (int j = 0; j < getNumInputsPort(id); ++j) {
-                  int id_orig = getIdInPort(id,j);
-                  if (id_orig > 0)
-                      in_port.at(j) = ports.at(id_orig - 1)->getOutput();
-                  else if (id_orig < 0)
-                      in_port.at(j) = in_circ.at(-id_orig - 1);
+  levelizar();
+  separarEstado();
+  prepararEstado(*estado);
+  // Sem estado anterior valido: simulacao completa
+  if (estado->estado_ok) propagarEventos(in_circ.data(), *estado);
+  else simularVetor(in_circ.data(), *estado);
+
+  // As saidas do circuito que mudaram
+  atualizarSaidas(*estado);
+  return estado->alteradas;
+}
+
+/// Simula um lote de Nvetores vetores de entrada, como simularLote, mas passando de um
+/// vetor ao seguinte pela simulacao incremental (cada vetor parte do estado do anterior).
+void Circuito::simularLoteIncremental(const bool3S* in_lote, int Nvetores, bool3S* out_lote)
+{
+  if (!valid()) throw std::logic_error("simularLoteIncremental: invalid circuit");
+  if (Nvetores < 0 || (Nvetores > 0 && (in_lote == nullptr || out_lote == nullptr)))
+    throw std::invalid_argument("simularLoteIncremental: invalid parameter(s)");
+  if (Nvetores == 0) return;
+
+  levelizar();
+  separarEstado();
+  prepararEstado(*estado);
+  executarLote(in_lote, Nvetores, out_lote, true, *estado);
+}
+
+/// Simula apenas o cone de influencia das saidas do circuito cujas ids estao em "saidas".
+/// O cone eh recalculado somente se as saidas mudaram ou o circuito foi modificado.
+void Circuito::simularCone(const std::vector<int>& saidas, const std::vector<bool3S>& in_circ)
+{
+  if (!valid()) throw std::logic_error("simularCone: invalid circuit");
+  if (static_cast<int>(in_circ.size()) != getNumInputs())
+    throw std::range_error("simularCone: incompatible parameter size");
+  for (int id : saidas) {
+      if (id<1 || id>getNumOutputs()) throw std::out_of_range("simularCone: invalid IdOutput");
+  }
+
+  levelizar();
+  separarEstado();
+  prepararEstado(*estado);
+  if (!cone_ok || saidas != saidas_cone) calcularCone(saidas);
+  bool3S* V = estado->valor.data() + Nin_circ;
+
+  // Entradas do circuito
+  for (int i = 0; i < getNumInputs(); ++i) {
+      V[-i-1] = in_circ[i];
+  }
+  // Portas do cone fora de lacos, em ordem topologica
+  for (int k = 0; k < Nacicl_cone; ++k) {
+      V[ordem_cone[k]] = simularPorta(ordem_cone[k], V);
+  }
+  // Portas do cone em lacos: como o cone contem todas as origens de suas portas, cada
+  // componente fortemente conexa estah inteira dentro ou inteira fora do cone
+  for (int k = Nacicl_cone; k < int(ordem_cone.size()); ++k) {
+      V[ordem_cone[k]] = bool3S::UNDEF;
+  }
+  for (int c : comp_cone) simularComponente(c, *estado);
+
+  // Apenas as saidas pedidas sao calculadas
+  for (int id = 1; id <= getNumOutputs(); ++id) estado->out_circ[id-1] = bool3S::UNDEF;
+  for (int id : saidas) estado->out_circ[id-1] = V[estr->id_out[id-1]];
+
+  // As portas fora do cone nao correspondem a este vetor de entrada
+  estado->estado_ok = false;
+}
+
+/// Calcula o cone de influencia das saidas do circuito cujas ids estao em "saidas":
+/// busca a partir das origens das saidas, seguindo as origens das entradas das portas.
+void Circuito::calcularCone(const std::vector<int>& saidas)
+{
+  std::vector<char> no_cone(getNumPorts(), 0);
+  std::vector<int> pilha;
+  for (int id : saidas) {
+      int orig = estr->id_out[id-1];
+      if (orig > 0 && !no_cone[orig-1]) {
+          no_cone[orig-1] = 1;
+          pilha.push_back(orig);
+      }
+  }
+  while (!pilha.empty()) {
+      int id = pilha.back();
+      pilha.pop_back();
+      for (int j = estr->ini_in[id-1]; j < estr->ini_in[id-1]+estr->Nin_port[id-1]; ++j) {
+          int orig = estr->id_in[j];
+          if (orig > 0 && !no_cone[orig-1]) {
+              no_cone[orig-1] = 1;
+              pilha.push_back(orig);
+          }
+      }
+  }
+
+  ordem_cone.clear();
+  for (int k = 0; k < getNumPorts(); ++k) {
+      if (k == estr->Nacicl) Nacicl_cone = int(ordem_cone.size());
+      if (no_cone[estr->ordem[k]-1]) ordem_cone.push_back(estr->ordem[k]);
+  }
+  if (estr->Nacicl == getNumPorts()) Nacicl_cone = int(ordem_cone.size());
+  comp_cone.clear();
+  for (int c = 0; c+1 < int(estr->ini_comp.size()); ++c) {
+      if (no_cone[estr->ordem[estr->ini_comp[c]]-1]) comp_cone.push_back(c);
+  }
+
+  saidas_cone = saidas;
+  cone_ok = true;
+}
+
+/// Simula apenas as saidas do circuito cujas ids estao em "saidas", avaliando sob demanda
+/// somente as portas necessarias.
+void Circuito::simularDemanda(const std::vector<int>& saidas, const std::vector<bool3S>& in_circ)
+{
+  if (!valid()) throw std::logic_error("simularDemanda: invalid circuit");
+  if (static_cast<int>(in_circ.size()) != getNumInputs())
+    throw std::range_error("simularDemanda: incompatible parameter size");
+  for (int id : saidas) {
+      if (id<1 || id>getNumOutputs()) throw std::out_of_range("simularDemanda: invalid IdOutput");
+  }
+
+  levelizar();
+  separarEstado();
+  prepararEstado(*estado);
+  if (!demanda_ok) prepararDemanda();
+  bool3S* V = estado->valor.data() + Nin_circ;
+
+  // Entradas do circuito
+  for (int i = 0; i < getNumInputs(); ++i) {
+      V[-i-1] = in_circ[i];
+  }
+  // Nova demanda: nenhuma porta avaliada (as marcas sao zeradas apenas quando o contador volta a 0)
+  if (++Ndemandas == 0) {
+      std::fill(marca_demanda.begin(), marca_demanda.end(), 0u);
+      Ndemandas = 1;
+  }
+  Navaliadas_demanda = 0;
+  for (int id : saidas) {
+      if (estr->id_out[id-1] > 0) demandar(estr->id_out[id-1]);
+  }
+
+  // Apenas as saidas pedidas sao calculadas
+  for (int id = 1; id <= getNumOutputs(); ++id) estado->out_circ[id-1] = bool3S::UNDEF;
+  for (int id : saidas) estado->out_circ[id-1] = V[estr->id_out[id-1]];
+
+  // As portas nao avaliadas nao correspondem a este vetor de entrada
+  estado->estado_ok = false;
+}
+
+/// Redimensiona os dados da avaliacao sob demanda: as entradas de cada porta sao lidas
+/// na ordem original e todos os custos sao zerados
+void Circuito::prepararDemanda()
+{
+  marca_demanda.assign(getNumPorts(), 0u);
+  Ndemandas = 0;
+  ordem_in_demanda.assign(estr->id_in.size(), 0);
+  custo_demanda.assign(getNumPorts(), 0);
+  laco_demanda.assign(getNumPorts(), 0);
+  for (int id = 1; id <= getNumPorts(); ++id) {
+      for (int j = 0; j < estr->Nin_port[id-1]; ++j) ordem_in_demanda[estr->ini_in[id-1]+j] = j;
+      // Uma porta que depende de um laco, mas que nao faz parte de nenhum, eh avaliada
+      // sozinha como as demais; as portas de um laco, junto com toda a componente
+      int c = estr->comp[id-1];
+      if (c < 0) continue;
+      bool laco = (estr->ini_comp[c+1]-estr->ini_comp[c] > 1);
+      for (int j = 0; j < estr->Nin_port[id-1]; ++j) {
+          if (estr->id_in[estr->ini_in[id-1]+j] == id) laco = true;
+      }
+      laco_demanda[id-1] = laco;
+  }
+  pilha_demanda.clear();
+  demanda_ok = true;
+}
+
+/// Coloca na pilha a porta IdPort ou, se ela estiver em um laco, a sua componente
+void Circuito::empilharDemanda(int IdPort)
+{
+  QuadroDemanda Q;
+  Q.id = (laco_demanda[IdPort-1] ? -(estr->comp[IdPort-1]+1) : IdPort);
+  Q.k = 0;
+  Q.j = 0;
+  Q.Nini = Navaliadas_demanda;
+  Q.res = bool3S::UNDEF;
+  pilha_demanda.push_back(Q);
+}
+
+/// Avalia sob demanda a porta IdPort, sem recursao: a pilha guarda as portas cuja avaliacao
+/// estah esperando o valor de alguma origem
+void Circuito::demandar(int IdPort)
+{
+  if (marca_demanda[IdPort-1] == Ndemandas) return;
+  pilha_demanda.clear();
+  empilharDemanda(IdPort);
+  bool3S* V = estado->valor.data() + Nin_circ;
+
+  while (!pilha_demanda.empty()) {
+      // Copia do quadro do topo: a pilha pode crescer (e ser realocada) durante o passo
+      QuadroDemanda Q = pilha_demanda.back();
+      bool esperando = false;
+
+      if (Q.id > 0) {
+          // Uma porta: le as entradas em ordem, parando no valor controlador
+          int id = Q.id;
+          const int* in = estr->id_in.data() + estr->ini_in[id-1];
+          const int* ord = ordem_in_demanda.data() + estr->ini_in[id-1];
+          int Nin = estr->Nin_port[id-1];
+          TipoPorta T = estr->tipo_port[id-1];
+          bool3S controlador = (T==TipoPorta::AN || T==TipoPorta::NA ? bool3S::FALSE :
+                                T==TipoPorta::OR || T==TipoPorta::NO ? bool3S::TRUE : bool3S::UNDEF);
+          // Antes de avaliar qualquer origem, procura o valor controlador entre as entradas
+          // que jah tem valor (entradas do circuito e portas jah avaliadas nesta demanda)
+          if (Q.k == 0 && controlador != bool3S::UNDEF) {
+              Q.k = 1;
+              for (int j = 0; j < Nin; ++j) {
+                  int orig = in[j];
+                  if ((orig < 0 || (orig > 0 && marca_demanda[orig-1] == Ndemandas)) &&
+                      V[orig] == controlador) {
+                      Q.res = controlador;
+                      Q.j = Nin;
+                      break;
+                  }
+              }
+          }
+          for (; Q.j < Nin; ++Q.j) {
+              int orig = in[ord[Q.j]];
+              if (orig > 0 && marca_demanda[orig-1] != Ndemandas) {
+                  esperando = true;
+                  break;
+              }
+              bool3S S = V[orig];
+              if (Q.j == 0) Q.res = S;
+              else if (T==TipoPorta::AN || T==TipoPorta::NA) Q.res = Q.res & S;
+              else if (T==TipoPorta::OR || T==TipoPorta::NO) Q.res = Q.res | S;
+              else Q.res = Q.res ^ S;
+              if (Q.res == controlador && T != TipoPorta::NT) {
+                  Q.j = Nin;
+                  break;
               }
-              ports.at(id-1)->simular(in_port);
-              if (getOutputPort(id) == bool3S::UNDEF)
-                  tudo_def = false;
-              else
-                  alguma_def = true;
+          }
+          if (esperando) {
+              pilha_demanda.back() = Q;
+              empilharDemanda(in[ord[Q.j]]);
+              continue;
+          }
+          bool inversora = (T==TipoPorta::NT || T==TipoPorta::NA || T==TipoPorta::NO || T==TipoPorta::NX);
+          V[id] = (inversora ? ~Q.res : Q.res);
+          marca_demanda[id-1] = Ndemandas;
+          ++Navaliadas_demanda;
+          custo_demanda[id-1] = Navaliadas_demanda-Q.Nini;
+          if (reordenar_demanda) reordenarEntradas(id);
+      }
+      else {
+          // Uma componente de um laco: todas as origens de fora da componente devem ser
+          // avaliadas antes de simular a componente inteira
+          int c = -Q.id-1;
+          int ini = estr->ini_comp[c];
+          int Nc = estr->ini_comp[c+1]-ini;
+          for (; Q.k < Nc; ++Q.k, Q.j = 0) {
+              int id = estr->ordem[ini+Q.k];
+              for (; Q.j < estr->Nin_port[id-1]; ++Q.j) {
+                  int orig = estr->id_in[estr->ini_in[id-1]+Q.j];
+                  if (orig > 0 && estr->comp[orig-1] != c && marca_demanda[orig-1] != Ndemandas) {
+                      esperando = true;
+                      break;
+                  }
+              }
+              if (esperando) break;
+          }
+          if (esperando) {
+              pilha_demanda.back() = Q;
+              int id = estr->ordem[ini+Q.k];
+              empilharDemanda(estr->id_in[estr->ini_in[id-1]+Q.j]);
+              continue;
+          }
+          for (int k = ini; k < ini+Nc; ++k) V[estr->ordem[k]] = bool3S::UNDEF;
+          simularComponente(c, *estado);
+          Navaliadas_demanda += Nc;
+          for (int k = ini; k < ini+Nc; ++k) {
+              marca_demanda[estr->ordem[k]-1] = Ndemandas;
+              custo_demanda[estr->ordem[k]-1] = Navaliadas_demanda-Q.Nini;
           }
       }
-  } while (!tudo_def && alguma_def);
+      pilha_demanda.pop_back();
+  }
+}
 
+/// Reordena as entradas da porta IdPort em ordem crescente do custo de suas origens
+/// (as entradas do circuito tem custo 0). Como a ordem anterior jah estava quase ordenada,
+/// a ordenacao por insercao faz poucas trocas.
+void Circuito::reordenarEntradas(int IdPort)
+{
+  const int* in = estr->id_in.data() + estr->ini_in[IdPort-1];
+  int* ord = ordem_in_demanda.data() + estr->ini_in[IdPort-1];
+  auto custo = [&](int j) { return (in[j] > 0 ? custo_demanda[in[j]-1] : 0); };
+  for (int j = 1; j < estr->Nin_port[IdPort-1]; ++j) {
+      int x = ord[j];
+      int cx = custo(x);
+      int i = j;
+      for (; i > 0 && custo(ord[i-1]) > cx; --i) ord[i] = ord[i-1];
+      ord[i] = x;
+  }
+}
+
+/// Atualiza os valores das portas a partir do estado da simulacao anterior,
+/// reavaliando apenas as portas afetadas pelas entradas de in_circ que mudaram.
+void Circuito::propagarEventos(const bool3S* in_circ, EstadoSimulacao& E) const
+{
+  const Estrutura& Est = *estr;
+  bool3S* V = E.valor.data() + Nin_circ;
+
+  // Eventos iniciais: as portas alimentadas pelas entradas que mudaram
+  bool laco = false;
+  for (int i = 0; i < getNumInputs(); ++i) {
+      if (in_circ[i] != V[-i-1]) {
+          V[-i-1] = in_circ[i];
+          laco = agendarFanout(Est.fanout_in, Est.ini_fanout_in[i], Est.ini_fanout_in[i+1], E) || laco;
+      }
+  }
+
+  // Propaga os eventos nivel a nivel: como o fanout de uma porta tem sempre nivel maior,
+  // cada porta eh reavaliada no maximo uma vez
+  for (int n = 1; n <= Est.Nniveis; ++n) {
+      for (int k = Est.ini_fila[n]; k < E.fim_fila[n]; ++k) {
+          int id = E.fila[k];
+          E.agendada[id-1] = 0;
+          bool3S S = simularPorta(id, V);
+          if (S != V[id]) {
+              V[id] = S;
+              laco = agendarFanout(Est.fanout, Est.ini_fanout[id-1], Est.ini_fanout[id], E) || laco;
+          }
+      }
+      E.fim_fila[n] = Est.ini_fila[n];
+  }
+
+  // Se alguma porta em laco foi afetada, refaz a parte do circuito com lacos desde o inicio,
+  // como na simulacao completa
+  if (laco) {
+      for (int k = Est.Nacicl; k < getNumPorts(); ++k) {
+          V[Est.ordem[k]] = bool3S::UNDEF;
+      }
+      simularLacos(E);
+  }
+}
+
+/// Atualiza as saidas do circuito a partir dos valores dos sinais,
+/// guardando em E.alteradas as ids das saidas que mudaram
+void Circuito::atualizarSaidas(EstadoSimulacao& E) const
+{
+  const Estrutura& Est = *estr;
+  const bool3S* V = E.valor.data() + Nin_circ;
+  // A capacidade de E.alteradas foi reservada por prepararEstado: nenhuma alocacao
+  E.alteradas.clear();
   for (int id = 1; id <= getNumOutputs(); ++id) {
-      int id_orig = getIdOutputCirc(id);
-      if (id_orig > 0)
-          out_circ.at(id-1) = ports.at(id_orig - 1)->getOutput();
-      else if (id_orig < 0)
-          out_circ.at(id-1) = in_circ.at(-id_orig - 1);
+      bool3S S = V[Est.id_out[id-1]];
+      if (S != E.out_circ[id-1]) {
+          E.out_circ[id-1] = S;
+          E.alteradas.push_back(id);
+      }
+  }
+}
+
+/// Coloca na fila de eventos as portas em lista[ini..fim-1] que ainda nao estao nela.
+/// Retorna true se alguma delas estiver em um laco (nivel -1).
+bool Circuito::agendarFanout(const std::vector<int>& lista, int ini, int fim, EstadoSimulacao& E) const
+{
+  const Estrutura& Est = *estr;
+  bool laco = false;
+  for (int j = ini; j < fim; ++j) {
+      int dest = lista[j];
+      int n = Est.nivel[dest-1];
+      if (n < 0) laco = true;
+      else if (!E.agendada[dest-1]) {
+          E.agendada[dest-1] = 1;
+          E.fila[E.fim_fila[n]++] = dest;
+      }
   }
+  return laco;
 }
@@ -1,6 +1,12 @@
 #ifndef _CIRCUITO_H_
 #define _CIRCUITO_H_
 
+#include <atomic>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <unordered_map>
 #include "bool3S.h"
 #include "porta.h"
 
@@ -15,6 +21,95 @@
 ///       (id da origem de uma entrada de porta ou de uma saida do circuito)
 /// ###########################################################################
 
+class Circuito;
+class CircuitoImutavel;
+
+///
+/// CLASSE ESTADOSIMULACAO
+///
+
+// O estado de uma simulacao: os valores de todos os sinais e os dados de trabalho usados
+// durante a simulacao. Fica separado da estrutura do circuito para que varias simulacoes
+// (p.ex. uma por thread) possam compartilhar o mesmo CircuitoImutavel, cada uma com seu estado.
+// Um estado eh preparado automaticamente para o circuito com que eh usado; usar o mesmo
+// estado com circuitos diferentes eh permitido, mas perde a simulacao anterior.
+class EstadoSimulacao
+{
+private:
+  friend class Circuito;
+  friend class CircuitoImutavel;
+
+  // A versao da estrutura do circuito para a qual o estado foi preparado (0: nenhuma)
+  unsigned long versao;
+  // O numero de entradas desse circuito
+  int Nin_circ;
+
+  // VALORES LOGICOS DE TODOS OS SINAIS
+  // Um unico vetor contiguo, indexado por Nin_circ+IdOrig:
+  // - valor.at(Nin_circ-i-1): valor da entrada do circuito cuja id=-(i+1)
+  // - valor.at(Nin_circ): sempre bool3S::UNDEF (origem indefinida, IdOrig==0)
+  // - valor.at(Nin_circ+id): valor da saida da porta cuja id=id
+  // Assim, o valor da origem de qualquer entrada de porta eh lido sem testes.
+  std::vector<bool3S> valor;
+
+  // VALORES DAS SAIDAS LOGICAS DO CIRCUITO
+  std::vector<bool3S> out_circ;
+
+  // true se o vetor valor e as saidas do circuito correspondem aa ultima simulacao
+  bool estado_ok;
+
+  // A lista de trabalho usada na simulacao de cada componente fortemente conexa e
+  // na_lista_comp.at(i) != 0 se a porta cuja id=i+1 estah nessa lista
+  std::vector<int> lista_comp;
+  std::vector<char> na_lista_comp;
+
+  // SIMULACAO INCREMENTAL (orientada a eventos)
+  // Fila de eventos, separada por nivel: as portas de nivel n a serem reavaliadas estao em
+  // fila[ini_fila[n]..fim_fila[n]-1] (ini_fila pertence ao circuito). Ha espaco reservado para
+  // todas as portas de cada nivel, de modo que a fila nunca precisa crescer.
+  std::vector<int> fila;
+  std::vector<int> fim_fila;
+  // agendada.at(i) != 0 se a porta cuja id=i+1 jah estah na fila de eventos
+  std::vector<char> agendada;
+  // As ids das saidas do circuito que mudaram na ultima simulacao
+  std::vector<int> alteradas;
+
+public:
+  // Um estado ainda nao preparado para nenhum circuito
+  EstadoSimulacao():
+    versao(0),
+    Nin_circ(0),
+    valor(),
+    out_circ(),
+    estado_ok(false),
+    lista_comp(),
+    na_lista_comp(),
+    fila(),
+    fim_fila(),
+    agendada(),
+    alteradas()
+  {}
+
+  // Retorna o valor logico da saida do circuito cuja id eh IdOutput na ultima simulacao.
+  // Gera excecao se o parametro for invalido.
+  bool3S getOutputCirc(int IdOutput) const
+  {
+    return out_circ.at(IdOutput-1);
+  }
+  // Retorna o valor logico da saida da porta cuja id eh IdPort na ultima simulacao.
+  // Gera excecao se o parametro for invalido.
+  bool3S getOutputPort(int IdPort) const
+  {
+    if (IdPort<1) throw std::out_of_range("getOutputPort: invalid ID");
+    return valor.at(Nin_circ+IdPort);
+  }
+  // As ids das saidas do circuito que mudaram na ultima simulacao
+  const std::vector<int>& getAlteradas() const
+  {
+    return alteradas;
+  }
+};
+
 ///
 /// CLASSE CIRCUITO
 ///
@@ -22,6 +117,11 @@
 class Circuito
 {
 private:
+  // O circuito imutavel usa as funcoes de simulacao const, com estados externos
+  friend class CircuitoImutavel;
+  // O construtor em bloco monta a estrutura diretamente
+  friend class ConstrutorCircuito;
+
   /// ***********************
   /// Dados
   /// ***********************
@@ -29,32 +129,343 @@ private:
   // NUMERO DE ENTRADAS DO CIRCUITO
   int Nin_circ;
 
-  // PORTAS DO CIRCUITO
-  std::vector<ptr_Porta> ports;
-
-  // VALORES DAS SAIDAS LOGICAS DO CIRCUITO
-  std::vector<bool3S> out_circ;
-
-  // CONECTIVIDADE DO CIRCUITO
-
-  // As ids das origens das entradas das portas
-  // Eh um vetor de vetores: o vetor principal deve ter dimensao "Nports"
-  // Cada vetor id_in.at(i) deve ter dimensao igual ao numero de entradas da porta cuja id=i+1
-  // se id_in.at(i).at(j)>0: a j-esima entrada da i-esima porta (id=i+1) vem da saida da porta
-  // cuja id eh o valor desse elemento do array
-  // se id_in.at(i).at(j)<0: a j-esima entrada da i-esima porta (id=i+1) vem da entrada do circuito
-  // cuja id eh o valor desse elemento do array
-  // se id_in.at(i).at(j)==0: a j-esima entrada da i-esima porta (id=i+1) estah indefinida
-  std::vector< std::vector<int> > id_in;
-
-  // As ids das origens dos sinais de saida do circuito
-  // Deve ser um vetor com dimensao "Nout"
-  // se id_out.at(i)>0: a i-esima saida do circuito (id=i+1) vem da saida da porta
-  // cuja id eh o valor desse elemento do array
-  // se id_out.at(i)<0: a i-esima saida do circuito (id=i+1) vem da entrada do circuito
-  // cuja id eh o valor desse elemento do array
-  // se id_out.at(i)==0: a i-esima saida do circuito (id=i+1) estah indefinida
-  std::vector<int> id_out;
+  // ESTRUTURA DO CIRCUITO
+  // As portas, a conectividade e a ordem de avaliacao ficam em um bloco separado, que eh
+  // compartilhado (por contagem de referencias) entre as copias do circuito: copiar um circuito
+  // nao copia nenhuma porta. Uma copia propria da estrutura soh eh feita na primeira modificacao
+  // (setPort, setIdInPort ou setIdOutputCirc) de um circuito cuja estrutura estah compartilhada.
+  struct Estrutura
+  {
+    // PORTAS DO CIRCUITO
+    // As portas sao armazenadas em vetores paralelos (uma posicao por porta), e nao como
+    // objetos Porta alocados individualmente: tipo_port.at(i), Nin_port.at(i) e ini_in.at(i)
+    // sao os dados da porta cuja id=i+1.
+
+    // O tipo de cada porta (NT, AN, etc.)
+    std::vector<TipoPorta> tipo_port;
+    // O numero de entradas de cada porta (0 se a porta ainda nao foi definida)
+    std::vector<int> Nin_port;
+
+    // CONECTIVIDADE DO CIRCUITO
+
+    // As ids das origens das entradas das portas, todas em um unico vetor:
+    // as origens das entradas da porta cuja id=i+1 estao em id_in[ini_in[i]..ini_in[i]+Nin_port[i]-1]
+    // se id_in>0: a entrada vem da saida da porta cuja id eh o valor desse elemento do array
+    // se id_in<0: a entrada vem da entrada do circuito cuja id eh o valor desse elemento do array
+    // se id_in==0: a entrada estah indefinida
+    // id_in eh o unico bloco de memoria das conexoes de todas as portas: nao ha nenhuma
+    // alocacao por porta, e tudo eh liberado de uma vez quando a estrutura eh descartada.
+    // Quando o numero de entradas de uma porta aumenta, suas origens sao realocadas para o fim
+    // do vetor (a porta que jah estah no fim eh redimensionada no proprio lugar); o espaco
+    // abandonado (Nlixo posicoes) eh recuperado por compactar(), que volta a deixar as origens
+    // de todas as portas contiguas e em ordem de id. Como compactar() eh chamada quando o espaco
+    // abandonado passa da metade, o tamanho de id_in nunca passa do dobro do numero de conexoes,
+    // por mais que as portas sejam alteradas.
+    std::vector<int> ini_in;
+    std::vector<int> id_in;
+    int Nlixo;
+
+    // As ids das origens dos sinais de saida do circuito
+    // Deve ser um vetor com dimensao "Nout"
+    // se id_out.at(i)>0: a i-esima saida do circuito (id=i+1) vem da saida da porta
+    // cuja id eh o valor desse elemento do array
+    // se id_out.at(i)<0: a i-esima saida do circuito (id=i+1) vem da entrada do circuito
+    // cuja id eh o valor desse elemento do array
+    // se id_out.at(i)==0: a i-esima saida do circuito (id=i+1) estah indefinida
+    std::vector<int> id_out;
+
+    // LEVELIZACAO DO CIRCUITO
+
+    // A ordem de avaliacao das portas eh calculada a partir de id_in apenas quando necessario
+    // e reaproveitada em todas as simulacoes seguintes, ate que o circuito seja modificado.
+    // Os dados abaixo sao um cache que pode ser recalculado inclusive pelas funcoes de
+    // consulta const, por qualquer uma das copias que compartilham a estrutura.
+    // ordem_ok: false se a ordem deve ser recalculada antes de ser usada
+    std::atomic<bool> ordem_ok;
+    // Garante que apenas uma das copias (possivelmente em threads diferentes) calcula a ordem
+    std::mutex trava_ordem;
+    // A versao da ordem de avaliacao: muda (sem repetir, entre todos os circuitos) a cada vez que a
+    // ordem eh recalculada, indicando que os estados de simulacao devem ser preparados de novo
+    unsigned long versao;
+    // As ids das portas na ordem de avaliacao: primeiro as portas em ordem topologica,
+    // depois as portas que estao em lacos ou que dependem deles, agrupadas por componente
+    // fortemente conexa, com as componentes em ordem topologica
+    std::vector<int> ordem;
+    // O numero de portas no inicio do vetor "ordem" que estao em ordem topologica
+    int Nacicl;
+    // A profundidade do circuito (o maior nivel entre as portas)
+    int Nniveis;
+    // O nivel de cada porta: nivel.at(i) eh o nivel da porta cuja id=i+1
+    // (1 + maior nivel entre as origens das entradas; entradas do circuito tem nivel 0)
+    // As portas em lacos ou que dependem deles tem nivel -1
+    std::vector<int> nivel;
+    // As portas alimentadas pela saida de cada porta (fanout), em formato compacto:
+    // as portas alimentadas pela porta id estao em fanout[ini_fanout[id-1]..ini_fanout[id]-1]
+    std::vector<int> ini_fanout;
+    std::vector<int> fanout;
+    // As portas alimentadas por cada entrada do circuito, no mesmo formato:
+    // as portas alimentadas pela entrada id=-(i+1) estao em fanout_in[ini_fanout_in[i]..ini_fanout_in[i+1]-1]
+    std::vector<int> ini_fanout_in;
+    std::vector<int> fanout_in;
+    // As componentes fortemente conexas das portas em lacos ou que dependem deles:
+    // as portas da componente c estao em ordem[ini_comp[c]..ini_comp[c+1]-1] e
+    // comp.at(i) eh a componente da porta cuja id=i+1 (-1 para as portas fora de lacos)
+    std::vector<int> ini_comp;
+    std::vector<int> comp;
+    // O inicio do trecho da fila de eventos (ver EstadoSimulacao) de cada nivel n: ha espaco para
+    // todas as portas de nivel n em fila[ini_fila[n]..ini_fila[n+1]-1]
+    std::vector<int> ini_fila;
+
+    // INDICE DE FANOUT E ORDEM TOPOLOGICA DINAMICOS
+    // Calculados junto com a primeira ordem de avaliacao e, a partir dai, mantidos por setPort e
+    // setIdInPort a cada alteracao de conexao, em vez de recalculados: cada alteracao soh visita
+    // as portas afetadas por ela.
+    // din_ok: false se ainda nao foram calculados (p.ex. em uma estrutura recem-copiada)
+    std::atomic<bool> din_ok;
+    // As portas alimentadas por cada origem: fanout_din.at(Nin_circ+IdOrig), com uma posicao
+    // por entrada de porta ligada a essa origem, em ordem qualquer (como o vetor valor do estado;
+    // a posicao da origem indefinida, IdOrig==0, fica vazia)
+    std::vector< std::vector<int> > fanout_din;
+    // topo_ok: true se o circuito nao tem lacos e ordem_din eh uma ordem topologica das portas,
+    // reparada localmente a cada nova conexao (algoritmo de Pearce e Kelly).
+    // Quando uma conexao fecha um laco, a ordem dinamica deixa de ser mantida ateh que a ordem
+    // de avaliacao seja recalculada do zero sem nenhum laco.
+    std::atomic<bool> topo_ok;
+    // A porta em cada posicao da ordem e a posicao de cada porta (pos_din.at(i): porta id=i+1)
+    std::vector<int> ordem_din;
+    std::vector<int> pos_din;
+    // O nivel de cada porta, mantido junto com a ordem (nivel_din.at(i): porta id=i+1)
+    std::vector<int> nivel_din;
+    // niveis_ok: false se ha portas alteradas cujo nivel (e o das portas que dependem delas)
+    // ainda deve ser recalculado. Os niveis sao reparados de uma soh vez, na proxima consulta,
+    // a partir das portas em pend_din (pendente_din.at(i) != 0 se a porta id=i+1 estah la)
+    std::atomic<bool> niveis_ok;
+    std::vector<int> pend_din;
+    std::vector<char> pendente_din;
+    // Dados de trabalho das buscas que reparam a ordem e os niveis
+    std::vector<char> marca_din;
+    std::vector<int> frente_din;
+    std::vector<int> tras_din;
+    std::vector<int> pos_aux_din;
+    std::vector<int> heap_din;
+
+    // Estrutura vazia
+    Estrutura():
+      tipo_port(),
+      Nin_port(),
+      ini_in(),
+      id_in(),
+      Nlixo(0),
+      id_out(),
+      ordem_ok(false),
+      trava_ordem(),
+      versao(0),
+      ordem(),
+      Nacicl(0),
+      Nniveis(0),
+      nivel(),
+      ini_fanout(),
+      fanout(),
+      ini_fanout_in(),
+      fanout_in(),
+      ini_comp(),
+      comp(),
+      ini_fila(),
+      din_ok(false),
+      fanout_din(),
+      topo_ok(false),
+      ordem_din(),
+      pos_din(),
+      nivel_din(),
+      niveis_ok(false),
+      pend_din(),
+      pendente_din(),
+      marca_din(),
+      frente_din(),
+      tras_din(),
+      pos_aux_din(),
+      heap_din()
+    {}
+    // Copia apenas as portas e a conectividade (a ordem de avaliacao e os dados dinamicos
+    // sao recalculados)
+    Estrutura(const Estrutura& S);
+    Estrutura& operator=(const Estrutura&) = delete;
+  };
+  // A estrutura deste circuito, possivelmente compartilhada com outras copias
+  // (nunca nula: um circuito vazio usa estruturaVazia())
+  std::shared_ptr<Estrutura> estr;
+
+  // O ESTADO DA SIMULACAO DO PROPRIO CIRCUITO
+  // (os valores de todos os sinais e das saidas do circuito)
+  // Tambem eh compartilhado entre as copias ateh a proxima simulacao ou modificacao de uma delas.
+  std::shared_ptr<EstadoSimulacao> estado;
+
+  // CONE DE INFLUENCIA
+  // As portas que alimentam, direta ou indiretamente, um subconjunto das saidas do circuito.
+  // O cone eh calculado na primeira simulacao de um subconjunto e reaproveitado ateh que o
+  // subconjunto mude ou o circuito seja modificado. cone_ok: false se o cone deve ser recalculado
+  bool cone_ok;
+  // As ids das saidas do circuito cujo cone estah calculado
+  std::vector<int> saidas_cone;
+  // As ids das portas do cone, na mesma ordem do vetor "ordem":
+  // as Nacicl_cone primeiras estao fora de lacos
+  std::vector<int> ordem_cone;
+  int Nacicl_cone;
+  // As componentes fortemente conexas (ver ini_comp) contidas no cone, em ordem topologica
+  std::vector<int> comp_cone;
+
+  // AVALIACAO SOB DEMANDA
+  // A partir das saidas pedidas, cada porta avalia as origens de suas entradas apenas quando
+  // precisa delas, parando assim que um valor controlador decide o seu resultado.
+  // demanda_ok: false se os dados abaixo devem ser redimensionados
+  bool demanda_ok;
+  // marca_demanda.at(i) == Ndemandas se a porta cuja id=i+1 jah foi avaliada na demanda atual
+  std::vector<unsigned> marca_demanda;
+  unsigned Ndemandas;
+  // laco_demanda.at(i) != 0 se a porta cuja id=i+1 soh pode ser avaliada junto com toda a sua
+  // componente fortemente conexa (porta em um laco)
+  std::vector<char> laco_demanda;
+  // A ordem em que as entradas de cada porta sao lidas: a j-esima entrada lida da porta id eh a
+  // entrada ordem_in_demanda[ini_in[id-1]+j] (mesmas posicoes de id_in)
+  std::vector<int> ordem_in_demanda;
+  // O custo observado de cada porta: o numero de portas avaliadas na ultima vez em que ela foi
+  // avaliada, incluindo ela mesma e as origens que ainda nao tinham sido avaliadas
+  std::vector<int> custo_demanda;
+  // true se as entradas de cada porta devem ser reordenadas em ordem crescente de custo
+  bool reordenar_demanda;
+  // O numero de portas avaliadas na ultima simulacao sob demanda
+  int Navaliadas_demanda;
+  // A pilha da avaliacao sob demanda: uma porta (id>0) ou uma componente fortemente conexa
+  // (id=-(c+1)) em avaliacao, a proxima entrada a ser lida (k: porta da componente,
+  // j: entrada da porta), o valor de Navaliadas_demanda no inicio e o resultado parcial.
+  // Em uma porta, k != 0 depois que as entradas jah disponiveis foram lidas em busca do
+  // valor controlador.
+  struct QuadroDemanda
+  {
+    int id;
+    int k;
+    int j;
+    int Nini;
+    bool3S res;
+  };
+  std::vector<QuadroDemanda> pilha_demanda;
+
+  // CACHE DE RESULTADOS
+  // Guarda as saidas calculadas por simular para os vetores de entrada mais recentes,
+  // ambos empacotados com 2 bits por valor (4 valores por char).
+  // Eh esvaziado sempre que o circuito eh modificado.
+  // O orcamento de memoria do cache, em bytes (0: cache desativado), e a memoria estimada em uso
+  size_t cache_max;
+  size_t cache_bytes;
+  // Os pares (entrada, saida) do cache, do mais recentemente usado para o menos
+  std::list< std::pair<std::string,std::string> > cache_lru;
+  // O indice do cache: entrada empacotada -> posicao em cache_lru
+  std::unordered_map< std::string, std::list< std::pair<std::string,std::string> >::iterator > cache_mapa;
+  // O numero de consultas ao cache que encontraram e que nao encontraram o vetor de entrada
+  long long cache_acertos;
+  long long cache_falhas;
+  // O vetor de entrada da consulta atual, empacotado
+  std::string chave_cache;
+
+  // A memoria estimada de cada resultado no cache, alem das entradas e saidas empacotadas
+  static const size_t CUSTO_RESULTADO_CACHE = 160;
+
+  // Esvazia o cache de resultados (sem alterar o orcamento e os contadores)
+  void invalidarCache() noexcept;
+  // Guarda no cache as saidas atuais do circuito para o vetor de entrada em chave_cache
+  void guardarCache();
+
+  // A estrutura e o estado de simulacao vazios, compartilhados por todos os circuitos vazios
+  static const std::shared_ptr<Estrutura>& estruturaVazia();
+  static const std::shared_ptr<EstadoSimulacao>& estadoVazio();
+  // Se a estrutura (ou o estado) estiver compartilhada com outras copias do circuito,
+  // passa a usar uma copia propria. Deve ser chamada antes de qualquer alteracao.
+  void separarEstrutura();
+  void separarEstado();
+  // Cria um estado de simulacao proprio, com todos os valores indefinidos,
+  // dimensionado para a estrutura atual
+  void iniciarEstado();
+
+  // Recalcula a ordem de avaliacao e os niveis das portas, se necessario
+  void levelizar() const;
+
+  // Calcula do zero a ordem de avaliacao, os niveis, o fanout compacto e as componentes
+  // fortemente conexas (exige a trava da estrutura)
+  void calcularOrdem() const;
+  // Calcula o indice de fanout e a ordem topologica dinamicos a partir da ordem recem-calculada
+  // (exige a trava da estrutura)
+  void calcularDinamico() const;
+  // Usa a ordem topologica dinamica como ordem de avaliacao (exige a trava da estrutura)
+  void reaproveitarOrdemDinamica() const;
+  // Garante que o indice de fanout dinamico estah calculado
+  void prepararDinamico() const;
+  // Retira ou acrescenta no indice de fanout dinamico a conexao da origem IdOrig para a porta
+  // IdPort, reparando a ordem topologica dinamica se necessario
+  void removerConexao(int IdOrig, int IdPort);
+  void inserirConexao(int IdOrig, int IdPort);
+  // Marca a porta IdPort para ter o seu nivel dinamico recalculado
+  void marcarNivel(int IdPort);
+  // Recalcula os niveis dinamicos das portas marcadas e propaga as mudancas para o seu fanout
+  // (repararNiveis exige a trava da estrutura)
+  void repararNiveis() const;
+  void atualizarNiveis() const;
+
+  // Reorganiza o vetor id_in, eliminando o espaco abandonado
+  void compactar();
+
+  // AS FUNCOES DE SIMULACAO ABAIXO sao const: so leem a estrutura do circuito e escrevem
+  // apenas no estado E. Exigem que a ordem de avaliacao esteja atualizada (levelizar) e que
+  // o estado tenha sido preparado para ela (prepararEstado). Podem ser chamadas por varias
+  // threads ao mesmo tempo, cada uma com seu estado (ver CircuitoImutavel).
+
+  // Prepara o estado E para a ordem de avaliacao atual, se necessario
+  void prepararEstado(EstadoSimulacao& E) const;
+
+  // Retorna a saida da porta cuja id eh IdPort, calculada com os valores dos sinais
+  // V (indexados por IdOrig)
+  bool3S simularPorta(int IdPort, const bool3S* V) const;
+
+  // Calcula os valores de todas as portas para o vetor de entrada in_circ (getNumInputs() valores),
+  // sem nenhuma checagem.
+  void simularVetor(const bool3S* in_circ, EstadoSimulacao& E) const;
+
+  // Atualiza os valores das portas para o vetor de entrada in_circ a partir do estado da
+  // simulacao anterior, reavaliando apenas as portas afetadas pelas entradas que mudaram.
+  void propagarEventos(const bool3S* in_circ, EstadoSimulacao& E) const;
+
+  // Simula as portas em lacos (ou que dependem deles), partindo de todas indefinidas,
+  // uma componente fortemente conexa de cada vez, ateh nao haver mais mudanca
+  void simularLacos(EstadoSimulacao& E) const;
+  // Simula as portas da componente fortemente conexa c, que devem estar todas indefinidas
+  void simularComponente(int c, EstadoSimulacao& E) const;
+
+  // Simula os Nvetores vetores de in_lote, escrevendo as saidas em out_lote, como simularLote
+  // (Incremental == false) ou simularLoteIncremental (Incremental == true), sem checagens
+  void executarLote(const bool3S* in_lote, int Nvetores, bool3S* out_lote,
+                    bool Incremental, EstadoSimulacao& E) const;
+
+  // Atualiza as saidas do circuito a partir dos valores dos sinais,
+  // guardando em E.alteradas as ids das saidas que mudaram
+  void atualizarSaidas(EstadoSimulacao& E) const;
+
+  // Coloca na fila de eventos as portas em lista[ini..fim-1] (um trecho de fanout ou fanout_in)
+  // Retorna true se alguma delas estiver em um laco (nivel -1).
+  bool agendarFanout(const std::vector<int>& lista, int ini, int fim, EstadoSimulacao& E) const;
+
+  // Redimensiona os dados da avaliacao sob demanda
+  void prepararDemanda();
+  // Avalia sob demanda a porta cuja id eh IdPort e, antes dela, as origens de que ela precisa.
+  // Exige que a ordem de avaliacao e os dados da avaliacao sob demanda estejam atualizados.
+  void demandar(int IdPort);
+  // Coloca na pilha da avaliacao sob demanda a porta cuja id eh IdPort ou, se ela estiver em
+  // um laco, a sua componente fortemente conexa
+  void empilharDemanda(int IdPort);
+  // Reordena as entradas da porta cuja id eh IdPort em ordem crescente de custo
+  void reordenarEntradas(int IdPort);
+
+  // Calcula o cone de influencia das saidas do circuito cujas ids estao em "saidas".
+  // Exige que a ordem de avaliacao esteja atualizada (levelizar).
+  void calcularCone(const std::vector<int>& saidas);
 
 public:
 
@@ -65,10 +476,29 @@ public:
   // Construtor default = circuito vazio
   Circuito():
     Nin_circ(0),
-    ports(),
-    out_circ(),
-    id_in(),
-    id_out()
+    estr(estruturaVazia()),
+    estado(estadoVazio()),
+    cone_ok(false),
+    saidas_cone(),
+    ordem_cone(),
+    Nacicl_cone(0),
+    comp_cone(),
+    demanda_ok(false),
+    marca_demanda(),
+    Ndemandas(0),
+    laco_demanda(),
+    ordem_in_demanda(),
+    custo_demanda(),
+    reordenar_demanda(false),
+    Navaliadas_demanda(0),
+    pilha_demanda(),
+    cache_max(0),
+    cache_bytes(0),
+    cache_lru(),
+    cache_mapa(),
+    cache_acertos(0),
+    cache_falhas(0),
+    chave_cache()
   {}
 
   // Cria o circuito com NI entradas, NO saidas e NP portas,
@@ -77,7 +507,8 @@ public:
     resize(NI,NO,NP);
   }
 
-  // Construtor por copia
+  // Construtor por copia: nao copia as portas nem a conectividade, que passam a ser
+  // compartilhadas com C ateh a primeira modificacao de um dos dois (tempo e memoria constantes)
   Circuito(const Circuito& C);
   // Construtor por movimento
   Circuito(Circuito&& C) noexcept;
@@ -90,7 +521,10 @@ public:
   // Limpa todo o conteudo do circuito.
   void clear() noexcept;
 
-  // Operador de atribuicao por copia
+  // Operador de atribuicao por copia (compartilha a estrutura de C, como o construtor por copia)
+  // As configuracoes de C (orcamento do cache e reordenacao da avaliacao sob demanda) sao
+  // copiadas junto com o circuito, tanto na copia quanto no movimento; o movimento tambem
+  // leva o cache e os seus contadores.
   Circuito& operator=(const Circuito& C);
   // Operador de atribuicao por movimento
   Circuito& operator=(Circuito&& C) noexcept;
@@ -129,11 +563,11 @@ public:
   }
   int getNumOutputs() const
   {
-    return int(out_circ.size());
+    return int(estr->id_out.size());
   }
   int getNumPorts() const
   {
-    return int(ports.size());
+    return int(estr->Nin_port.size());
   }
 
   // Retorna o nome da porta cuja id eh IdPort: AN, NX, etc.
@@ -160,6 +594,27 @@ public:
   // Gera excecao se o parametro for invalido.
   int getIdOutputCirc(int IdOutput) const;
 
+  // Retorna o nivel da porta cuja id eh IdPort: 1 + o maior nivel entre as origens
+  // das suas entradas (as entradas do circuito tem nivel 0).
+  // Retorna -1 se a porta estiver em um laco ou depender da saida de um laco.
+  // Gera excecao se o parametro for invalido.
+  int getNivelPort(int IdPort) const;
+
+  // Retorna a profundidade do circuito (o maior nivel entre as portas fora de lacos)
+  int getProfundidade() const;
+
+  // Retorna true se o circuito nao tem lacos (realimentacoes)
+  // Enquanto o circuito nao tem lacos, getNivelPort e aciclico nao precisam recalcular a ordem
+  // de avaliacao depois de uma alteracao: a ordem topologica e os niveis sao mantidos.
+  bool aciclico() const;
+
+  // O fanout da origem IdOrig (uma porta ou uma entrada do circuito): o numero de entradas de
+  // porta ligadas a ela e a id da porta da I-esima dessas entradas (em ordem qualquer).
+  // O indice de fanout eh mantido a cada alteracao do circuito, sem ser reconstruido.
+  // Gera excecao se algum parametro for invalido.
+  int getNumFanout(int IdOrig) const;
+  int getIdFanout(int IdOrig, int I) const;
+
   /// ***********************
   /// Funcoes de modificacao
   /// ***********************
@@ -202,8 +657,128 @@ public:
 
   // Calcula as saidas do circuito para os valores de entrada passados como parametro,
   // caso o circuito e o parametro de entrada sejam validos.
+  // Depois da primeira simulacao de um circuito, nao faz nenhuma alocacao de memoria
+  // (exceto para guardar novos resultados no cache, se ele estiver ativado).
+  // As portas sao avaliadas uma unica vez, em ordem topologica; apenas as portas em lacos
+  // (ou que dependem deles) sao repetidamente avaliadas ate nao haver mais mudanca.
+  // Se o cache de resultados estiver ativado e contiver o vetor de entrada, as saidas sao
+  // obtidas do cache, sem simulacao: nesse caso os valores das portas (getOutputPort)
+  // nao sao atualizados.
   // Se o circuito ou o parametro forem invalidos, gera excecao.
   void simular(const std::vector<bool3S>& in_circ);
+
+  // Simulacao incremental (orientada a eventos).
+  // Mantem o estado da simulacao anterior e reavalia apenas as portas alimentadas,
+  // direta ou indiretamente, pelas entradas que mudaram, em ordem crescente de nivel.
+  // Produz sempre o mesmo resultado que a funcao simular.
+  // Retorna as ids das saidas do circuito cujo valor mudou em relacao aa simulacao anterior.
+  // O vetor retornado pertence ao circuito e soh eh valido ateh a proxima simulacao.
+  // Se o circuito ou o parametro forem invalidos, gera excecao.
+  const std::vector<int>& simularIncremental(const std::vector<bool3S>& in_circ);
+
+  // Simulacao em lote: calcula as saidas do circuito para Nvetores vetores de entrada.
+  // O v-esimo vetor ocupa in_lote[v*getNumInputs() .. (v+1)*getNumInputs()-1] e suas saidas
+  // sao escritas em out_lote[v*getNumOutputs() .. (v+1)*getNumOutputs()-1], que deve ter
+  // espaco para Nvetores*getNumOutputs() valores.
+  // A validacao e a preparacao do circuito sao feitas uma unica vez para todo o lote.
+  // Ao final, as saidas do circuito (getOutputCirc) sao as do ultimo vetor do lote.
+  // Se o circuito ou os parametros forem invalidos, gera excecao.
+  void simularLote(const bool3S* in_lote, int Nvetores, bool3S* out_lote);
+  // Idem, com os vetores de entrada em in_lote (in_lote.size() deve ser multiplo de getNumInputs()).
+  // out_lote eh redimensionado para in_lote.size()/getNumInputs()*getNumOutputs() valores.
+  void simularLote(const std::vector<bool3S>& in_lote, std::vector<bool3S>& out_lote);
+
+  // Simulacao em lote incremental: como simularLote, mas cada vetor eh simulado a partir do
+  // estado deixado pelo vetor anterior (como em simularIncremental), reavaliando apenas as
+  // portas afetadas pelas entradas que mudaram. Eh vantajosa quando vetores consecutivos do lote
+  // diferem em poucas entradas (p.ex. enumeracao em codigo de Gray).
+  // Se o circuito ou os parametros forem invalidos, gera excecao.
+  void simularLoteIncremental(const bool3S* in_lote, int Nvetores, bool3S* out_lote);
+
+  // Simulacao do cone de influencia: calcula apenas as saidas do circuito cujas ids estao em
+  // "saidas", avaliando somente as portas que as alimentam, direta ou indiretamente.
+  // O cone eh guardado e reaproveitado nas simulacoes seguintes com as mesmas saidas, ateh que
+  // o circuito seja modificado (setPort, setIdInPort ou setIdOutputCirc); a partir da segunda
+  // simulacao com as mesmas saidas, nao faz nenhuma alocacao de memoria.
+  // As demais saidas do circuito ficam bool3S::UNDEF e as portas fora do cone nao sao alteradas.
+  // Se o circuito ou os parametros forem invalidos, gera excecao.
+  void simularCone(const std::vector<int>& saidas, const std::vector<bool3S>& in_circ);
+
+  // Simulacao sob demanda: calcula apenas as saidas do circuito cujas ids estao em "saidas".
+  // Parte das saidas pedidas e avalia recursivamente as origens das entradas de cada porta,
+  // cada uma no maximo uma vez, parando assim que um valor controlador decide o resultado da
+  // porta (FALSE em AND e NAND, TRUE em OR e NOR, UNDEF em XOR e NXOR): as origens das
+  // entradas restantes nao sao avaliadas. As portas em lacos sao avaliadas junto com toda a sua
+  // componente fortemente conexa, como em simular.
+  // Produz as mesmas saidas pedidas que simular; as demais saidas do circuito ficam
+  // bool3S::UNDEF e as portas nao avaliadas nao sao alteradas.
+  // Se o circuito ou os parametros forem invalidos, gera excecao.
+  void simularDemanda(const std::vector<int>& saidas, const std::vector<bool3S>& in_circ);
+
+  // Se Reordenar == true, a simulacao sob demanda passa a ler as entradas de cada porta em
+  // ordem crescente do custo observado das suas origens (o numero de portas que precisaram ser
+  // avaliadas da ultima vez), de modo que um valor controlador barato seja encontrado antes.
+  // O resultado nao muda, pois as operacoes das portas sao comutativas.
+  void setReordenarDemanda(bool Reordenar)
+  {
+    reordenar_demanda = Reordenar;
+  }
+  // Retorna o numero de portas avaliadas na ultima chamada a simularDemanda
+  int getNumAvaliadasDemanda() const
+  {
+    return Navaliadas_demanda;
+  }
+
+  /// ***********************
+  /// COMPILACAO
+  /// ***********************
+
+  // Retorna uma copia imutavel e jah preparada deste circuito (ver circuitoimutavel.h), que pode
+  // ser compartilhada e simulada ao mesmo tempo por varias threads, cada uma com seu estado.
+  // Alteracoes posteriores neste circuito nao afetam a copia.
+  // Se o circuito for invalido, gera excecao.
+  std::shared_ptr<const CircuitoImutavel> compilar() const;
+
+  /// ***********************
+  /// CACHE DE RESULTADOS
+  /// ***********************
+
+  // Ativa o cache de resultados de simular, com um orcamento de MaxBytes bytes de memoria
+  // (0 desativa o cache). Quando o orcamento eh excedido, os resultados usados ha mais tempo
+  // sao descartados. Esvazia o cache e zera os contadores de acertos e falhas.
+  // O cache eh esvaziado automaticamente sempre que o circuito eh modificado
+  // (setPort, setIdInPort, setIdOutputCirc, resize, ler, atribuicao).
+  void setCacheResultados(size_t MaxBytes);
+  // O orcamento de memoria do cache, em bytes (0 se estiver desativado)
+  size_t getCacheResultados() const
+  {
+    return cache_max;
+  }
+  // A memoria estimada em uso pelo cache, em bytes, e o numero de resultados guardados
+  size_t getCacheBytes() const
+  {
+    return cache_bytes;
+  }
+  int getCacheNumResultados() const
+  {
+    return int(cache_mapa.size());
+  }
+  // O numero de simulacoes cujo resultado foi e nao foi encontrado no cache
+  long long getCacheAcertos() const
+  {
+    return cache_acertos;
+  }
+  long long getCacheFalhas() const
+  {
+    return cache_falhas;
+  }
+
+  // Retorna o numero de portas do cone de influencia da ultima chamada a simularCone
+  // (0 se o cone nao estiver calculado)
+  int getNumPortsCone() const
+  {
+    return (cone_ok ? int(ordem_cone.size()) : 0);
+  }
 };
 
 // Operador de impressao da classe Circuit
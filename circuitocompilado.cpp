@@ -0,0 +1,273 @@
+#include <stdexcept>
+#include <fstream>
+#include <sstream>
+#include <iterator>
+#include <cstdlib>
+#include "circuitocompilado.h"
+
+#if defined(__unix__) || defined(__APPLE__)
+#define CIRCUITOCOMPILADO_DLOPEN
+#include <dlfcn.h>
+#include <unistd.h>
+#endif
+
+///
+/// CLASSE CIRCUITOCOMPILADO
+///
+
+const char* CircuitoCompilado::NOME_FUNCAO = "simular_circuito";
+
+namespace {
+
+// O nome da variavel que guarda o trilho r ('f' ou 't') do sinal cuja id eh IdOrig
+std::string nomeSinal(char r, int IdOrig)
+{
+  std::ostringstream O;
+  if (IdOrig < 0) O << r << "_e" << -IdOrig;
+  else O << r << "_p" << IdOrig;
+  return O.str();
+}
+
+#ifdef CIRCUITOCOMPILADO_DLOPEN
+// Remove os arquivos temporarios da compilacao
+void removerTemporarios(const std::string& dir)
+{
+  unlink((dir+"/circuito.cpp").c_str());
+  unlink((dir+"/circuito.so").c_str());
+  unlink((dir+"/erros.txt").c_str());
+  rmdir(dir.c_str());
+}
+#endif
+
+} // namespace
+
+/// ***********************
+/// Geracao de codigo
+/// ***********************
+
+/// Escreve em O o codigo C++ da funcao que simula o circuito C.
+/// Cada porta eh uma operacao sobre as duas palavras (f,t) de suas entradas, na forma dual-rail,
+/// com exatamente a mesma semantica dos kernels de avaliacao (ver kernelsportas_impl.h).
+std::ostream& CircuitoCompilado::gerarCodigo(const Circuito& C, std::ostream& O)
+{
+  if (!C.valid()) throw std::logic_error("gerarCodigo: invalid circuit");
+  if (!C.aciclico()) throw std::logic_error("gerarCodigo: circuit with loops");
+
+  int id, j;
+
+  // Ordem topologica: as portas em ordem crescente de nivel
+  int Nniveis = C.getProfundidade();
+  std::vector<int> ini_nivel(Nniveis+2, 0);
+  for (id=1; id<=C.getNumPorts(); ++id) ++ini_nivel.at(C.getNivelPort(id)+1);
+  for (j=1; j<=Nniveis+1; ++j) ini_nivel.at(j) += ini_nivel.at(j-1);
+  std::vector<int> ordem(C.getNumPorts());
+  for (id=1; id<=C.getNumPorts(); ++id) ordem.at(ini_nivel.at(C.getNivelPort(id))++) = id;
+
+  O << "// Codigo gerado por CircuitoCompilado::gerarCodigo\n"
+    << "// Circuito com " << C.getNumInputs() << " entradas, " << C.getNumOutputs()
+    << " saidas e " << C.getNumPorts() << " portas\n"
+    << "#include <cstdint>\n\n"
+    << "extern \"C\" void " << NOME_FUNCAO << "(const uint64_t* in, uint64_t* out)\n{\n";
+
+  // Entradas do circuito
+  for (j=0; j<C.getNumInputs(); ++j)
+  {
+    O << "  const uint64_t " << nomeSinal('f',-(j+1)) << " = in[" << 2*j << "], "
+      << nomeSinal('t',-(j+1)) << " = in[" << 2*j+1 << "];\n";
+  }
+
+  // Portas: as inversoras trocam os trilhos
+  for (int k=0; k<C.getNumPorts(); ++k)
+  {
+    id = ordem.at(k);
+    TipoPorta T = toTipoPorta(C.getNamePort(id));
+    int Nin = C.getNumInputsPort(id);
+    bool inv = (T==TipoPorta::NT || T==TipoPorta::NA || T==TipoPorta::NO || T==TipoPorta::NX);
+    std::string f = nomeSinal(inv ? 't' : 'f', id);
+    std::string t = nomeSinal(inv ? 'f' : 't', id);
+
+    O << "  // " << id << ": " << C.getNamePort(id) << "\n";
+    if (T==TipoPorta::NT)
+    {
+      O << "  const uint64_t " << f << " = " << nomeSinal('f',C.getIdInPort(id,0)) << ", "
+        << t << " = " << nomeSinal('t',C.getIdInPort(id,0)) << ";\n";
+    }
+    else if (T==TipoPorta::XO || T==TipoPorta::NX)
+    {
+      O << "  uint64_t " << f << ", " << t << ";\n  {\n"
+        << "    uint64_t f = " << nomeSinal('f',C.getIdInPort(id,0))
+        << ", t = " << nomeSinal('t',C.getIdInPort(id,0)) << ", nf;\n";
+      for (j=1; j<Nin; ++j)
+      {
+        std::string f2 = nomeSinal('f',C.getIdInPort(id,j));
+        std::string t2 = nomeSinal('t',C.getIdInPort(id,j));
+        O << "    nf = (f & " << f2 << ") | (t & " << t2 << "); "
+          << "t = (f & " << t2 << ") | (t & " << f2 << "); f = nf;\n";
+      }
+      O << "    " << f << " = f; " << t << " = t;\n  }\n";
+    }
+    else
+    {
+      // AND: f = OR dos f, t = AND dos t; OR: o contrario
+      bool e = (T==TipoPorta::AN || T==TipoPorta::NA);
+      O << "  const uint64_t " << f << " = ";
+      for (j=0; j<Nin; ++j) O << (j>0 ? (e ? " | " : " & ") : "") << nomeSinal('f',C.getIdInPort(id,j));
+      O << ";\n  const uint64_t " << t << " = ";
+      for (j=0; j<Nin; ++j) O << (j>0 ? (e ? " & " : " | ") : "") << nomeSinal('t',C.getIdInPort(id,j));
+      O << ";\n";
+    }
+  }
+
+  // Saidas do circuito
+  for (j=0; j<C.getNumOutputs(); ++j)
+  {
+    int id_orig = C.getIdOutputCirc(j+1);
+    O << "  out[" << 2*j << "] = " << nomeSinal('f',id_orig) << "; "
+      << "out[" << 2*j+1 << "] = " << nomeSinal('t',id_orig) << ";\n";
+  }
+  O << "}\n";
+  return O;
+}
+
+/// ***********************
+/// Inicializacao
+/// ***********************
+
+/// Compila o circuito C com o comando "compilador" e carrega o resultado.
+CircuitoCompilado::CircuitoCompilado(const Circuito& C, const std::string& compilador)
+    : Nin_circ(C.getNumInputs()),
+      Nout_circ(C.getNumOutputs()),
+      biblioteca(nullptr),
+      funcao(nullptr),
+      interpretador(),
+      in_interp(),
+      in_bits(2*Nin_circ, ~uint64_t(0)),
+      out_bits(2*Nout_circ, ~uint64_t(0))
+{
+  if (!C.valid()) throw std::logic_error("CircuitoCompilado: invalid circuit");
+
+#ifdef CIRCUITOCOMPILADO_DLOPEN
+  if (C.aciclico())
+  {
+    // Diretorio temporario para o codigo fonte e a biblioteca
+    const char* tmp = getenv("TMPDIR");
+    std::string modelo = std::string(tmp!=nullptr && *tmp!='\0' ? tmp : "/tmp") + "/circuitoXXXXXX";
+    std::vector<char> nome(modelo.begin(), modelo.end());
+    nome.push_back('\0');
+    if (mkdtemp(nome.data()) == nullptr)
+      throw std::runtime_error("CircuitoCompilado: cannot create temporary directory");
+    std::string dir(nome.data());
+
+    std::ofstream fonte(dir+"/circuito.cpp");
+    gerarCodigo(C, fonte);
+    fonte.close();
+    if (!fonte)
+    {
+      removerTemporarios(dir);
+      throw std::runtime_error("CircuitoCompilado: cannot write source file");
+    }
+
+    std::string comando = compilador + " -shared -fPIC -o \"" + dir + "/circuito.so\" \"" +
+                          dir + "/circuito.cpp\" 2> \"" + dir + "/erros.txt\"";
+    if (system(comando.c_str()) != 0)
+    {
+      std::ifstream E(dir+"/erros.txt");
+      std::string erros((std::istreambuf_iterator<char>(E)), std::istreambuf_iterator<char>());
+      removerTemporarios(dir);
+      throw std::runtime_error("CircuitoCompilado: compilation failed: " + erros);
+    }
+
+    // Depois de carregada, a biblioteca pode ser removida do disco
+    biblioteca = dlopen((dir+"/circuito.so").c_str(), RTLD_NOW | RTLD_LOCAL);
+    if (biblioteca != nullptr)
+    {
+      funcao = reinterpret_cast<FuncaoSimular>(dlsym(biblioteca, NOME_FUNCAO));
+    }
+    removerTemporarios(dir);
+    if (funcao == nullptr)
+    {
+      const char* msg = dlerror();
+      std::string erro(msg!=nullptr ? msg : "");
+      if (biblioteca != nullptr) dlclose(biblioteca);
+      biblioteca = nullptr;
+      throw std::runtime_error("CircuitoCompilado: cannot load library: " + erro);
+    }
+    return;
+  }
+#endif
+
+  // Circuito com lacos (ou sistema sem dlopen): usa o interpretador de 64 padroes
+  interpretador.reset(new SimuladorBits(C, kernelEscalar()));
+  in_interp.resize(Nin_circ);
+}
+
+/// Descarrega a biblioteca
+CircuitoCompilado::~CircuitoCompilado()
+{
+#ifdef CIRCUITOCOMPILADO_DLOPEN
+  if (biblioteca != nullptr) dlclose(biblioteca);
+#endif
+}
+
+/// ***********************
+/// SIMULACAO
+/// ***********************
+
+/// Simula os 64 padroes que estao em in_bits, deixando as saidas em out_bits
+void CircuitoCompilado::simularBits()
+{
+  if (funcao != nullptr)
+  {
+    funcao(in_bits.data(), out_bits.data());
+    return;
+  }
+
+  for (int i=0; i<Nin_circ; ++i) in_interp[i] = bool3S64(in_bits[2*i], in_bits[2*i+1]);
+  interpretador->simular(in_interp);
+  for (int j=0; j<Nout_circ; ++j)
+  {
+    bool3S64 S = interpretador->getOutputCirc(j+1);
+    out_bits[2*j] = S.f;
+    out_bits[2*j+1] = S.t;
+  }
+}
+
+/// Calcula as saidas do circuito para os valores de entrada passados como parametro
+void CircuitoCompilado::simular(const std::vector<bool3S>& in_circ)
+{
+  if (static_cast<int>(in_circ.size()) != getNumInputs())
+    throw std::range_error("simular: incompatible parameter size");
+  for (int i=0; i<Nin_circ; ++i)
+  {
+    bool3S64 B(in_circ[i]);
+    in_bits[2*i] = B.f;
+    in_bits[2*i+1] = B.t;
+  }
+  simularBits();
+}
+
+/// Calcula as saidas do circuito para 64 vetores de entrada de uma soh vez
+void CircuitoCompilado::simular(const std::vector<bool3S64>& in_circ)
+{
+  if (static_cast<int>(in_circ.size()) != getNumInputs())
+    throw std::range_error("simular: incompatible parameter size");
+  for (int i=0; i<Nin_circ; ++i)
+  {
+    in_bits[2*i] = in_circ[i].f;
+    in_bits[2*i+1] = in_circ[i].t;
+  }
+  simularBits();
+}
+
+/// Retorna a saida do circuito cuja id eh IdOutput na ultima chamada a simular.
+bool3S CircuitoCompilado::getOutputCirc(int IdOutput) const
+{
+  return getOutputCirc64(IdOutput).get(0);
+}
+
+/// Retorna os 64 valores da saida do circuito cuja id eh IdOutput na ultima simulacao.
+bool3S64 CircuitoCompilado::getOutputCirc64(int IdOutput) const
+{
+  if (IdOutput<1 || IdOutput>getNumOutputs()) throw std::out_of_range("getOutputCirc: invalid ID");
+  return bool3S64(out_bits[2*(IdOutput-1)], out_bits[2*(IdOutput-1)+1]);
+}
@@ -0,0 +1,103 @@
+#ifndef _CIRCUITOCOMPILADO_H_
+#define _CIRCUITOCOMPILADO_H_
+
+#include <iostream>
+#include <string>
+#include <memory>
+#include <vector>
+#include "bool3S64.h"
+#include "circuito.h"
+#include "simuladorbits.h"
+
+///
+/// CLASSE CIRCUITOCOMPILADO
+///
+
+// Um circuito compilado para codigo nativo.
+// O circuito eh traduzido para uma funcao C++ sem desvios (uma variavel local por porta,
+// em ordem topologica), que simula 64 padroes de uma vez na forma dual-rail (ver bool3S64.h).
+// Essa funcao eh compilada pelo compilador do sistema como biblioteca dinamica,
+// que eh carregada com dlopen.
+// Circuitos com lacos nao podem ser traduzidos para codigo sem desvios: nesse caso,
+// e nos sistemas sem dlopen, o circuito eh simulado pelo interpretador (SimuladorBits).
+// Assim como o SimuladorBits, nao acompanha as modificacoes posteriores do Circuito:
+// se o circuito mudar, deve ser construido de novo.
+class CircuitoCompilado
+{
+private:
+  // NUMERO DE ENTRADAS E SAIDAS DO CIRCUITO
+  int Nin_circ;
+  int Nout_circ;
+
+  // A funcao compilada, com as entradas e saidas na forma in[2*i]=f e in[2*i+1]=t
+  typedef void (*FuncaoSimular)(const uint64_t* in, uint64_t* out);
+  // A biblioteca carregada (retorno de dlopen) e a funcao compilada (nullptr se nao compilado)
+  void* biblioteca;
+  FuncaoSimular funcao;
+
+  // O interpretador usado quando o circuito nao foi compilado e suas entradas
+  std::unique_ptr<SimuladorBits> interpretador;
+  std::vector<bool3S64> in_interp;
+
+  // As entradas e saidas da ultima simulacao (2 palavras por sinal)
+  std::vector<uint64_t> in_bits;
+  std::vector<uint64_t> out_bits;
+
+  // Simula os 64 padroes que estao em in_bits, deixando as saidas em out_bits
+  void simularBits();
+
+public:
+  // O nome da funcao gerada por gerarCodigo
+  static const char* NOME_FUNCAO;
+
+  // Nao existe circuito compilado sem circuito
+  CircuitoCompilado() = delete;
+  // Nao pode ser copiado (a biblioteca carregada pertence ao objeto)
+  CircuitoCompilado(const CircuitoCompilado&) = delete;
+  CircuitoCompilado& operator=(const CircuitoCompilado&) = delete;
+
+  // Compila o circuito C com o comando "compilador" (ao qual sao acrescentadas as opcoes
+  // para gerar uma biblioteca dinamica) e carrega o resultado.
+  // Se o circuito tiver lacos, usa o interpretador.
+  // Se o circuito for invalido ou a compilacao falhar, gera excecao.
+  explicit CircuitoCompilado(const Circuito& C, const std::string& compilador="c++ -O2");
+  // Descarrega a biblioteca
+  ~CircuitoCompilado();
+
+  int getNumInputs() const
+  {
+    return Nin_circ;
+  }
+  int getNumOutputs() const
+  {
+    return Nout_circ;
+  }
+  // Retorna true se o circuito foi compilado, false se estah sendo usado o interpretador
+  bool compilado() const
+  {
+    return funcao != nullptr;
+  }
+
+  // Calcula as saidas do circuito para os valores de entrada passados como parametro
+  // (a mesma interface de Circuito::simular).
+  // Se o parametro for invalido, gera excecao.
+  void simular(const std::vector<bool3S>& in_circ);
+  // Retorna a saida do circuito cuja id eh IdOutput na ultima chamada a simular.
+  // Gera excecao se o parametro for invalido.
+  bool3S getOutputCirc(int IdOutput) const;
+
+  // Calcula as saidas do circuito para 64 vetores de entrada de uma soh vez:
+  // o k-esimo valor de in_circ.at(i) eh o valor da entrada id=-(i+1) no k-esimo vetor.
+  // Se o parametro for invalido, gera excecao.
+  void simular(const std::vector<bool3S64>& in_circ);
+  // Retorna os 64 valores da saida do circuito cuja id eh IdOutput na ultima simulacao.
+  // Gera excecao se o parametro for invalido.
+  bool3S64 getOutputCirc64(int IdOutput) const;
+
+  // Escreve em O o codigo C++ da funcao que simula o circuito C, que deve ser valido e aciclico:
+  // extern "C" void NOME_FUNCAO(const uint64_t* in, uint64_t* out)
+  // Se o circuito for invalido ou tiver lacos, gera excecao.
+  static std::ostream& gerarCodigo(const Circuito& C, std::ostream& O);
+};
+
+#endif // _CIRCUITOCOMPILADO_H_
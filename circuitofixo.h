@@ -0,0 +1,287 @@
+#ifndef _CIRCUITOFIXO_H_
+#define _CIRCUITOFIXO_H_
+
+#include <algorithm>
+#include <ostream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+#include "bool3S.h"
+#include "bool3S64.h"
+#include "porta.h"
+#include "circuito.h"
+
+///
+/// CIRCUITOS FIXOS (DEFINIDOS EM TEMPO DE COMPILACAO)
+///
+
+// Um circuito sem lacos descrito inteiramente por parametros de template, p.ex. o de circuito.txt:
+//
+//   typedef CircuitoFixo<3, SaidasFixas<5, -3, 7>,
+//                        PortaFixa<3, TipoPorta::NO, -2, -3>,
+//                        PortaFixa<2, TipoPorta::AN, -1, -2, 3>,
+//                        ... > Exemplo;
+//   Exemplo::simular(in, out);
+//
+// - o primeiro parametro eh o numero de entradas do circuito;
+// - SaidasFixas<IdOrig...> sao as origens das saidas do circuito (id=1, 2, ...);
+// - cada PortaFixa<IdPort, Tipo, IdOrig...> eh uma porta, com sua id, seu tipo e as origens
+//   de suas entradas. As portas devem estar em ordem de avaliacao: as origens de cada porta
+//   sao entradas do circuito ou portas listadas antes dela.
+// Todas as ids sao conferidas em tempo de compilacao (static_assert).
+// Como todos os indices sao constantes, o compilador desenrola a avaliacao e mantem os sinais
+// em registradores: nao ha nenhuma interpretacao do circuito durante a simulacao.
+// O programa gerarcircuitofixo (gerarcircuitofixo.cpp) gera a declaracao a partir de um
+// arquivo no formato de Circuito::ler, e CircuitoFixo::toCircuito faz a conversao inversa.
+
+// Uma porta do circuito fixo
+template<int IdPort, TipoPorta Tipo, int... IdOrig>
+struct PortaFixa
+{
+};
+
+// As origens das saidas do circuito fixo
+template<int... IdOrig>
+struct SaidasFixas
+{
+};
+
+// Detalhes de implementacao
+namespace circuito_fixo {
+
+// Uma lista de ids
+template<int... Ids>
+struct ListaIds
+{
+};
+
+// valor == true se X estah entre Ids
+template<int X, int... Ids>
+struct Pertence
+{
+  static constexpr bool valor = false;
+};
+template<int X, int I, int... Ids>
+struct Pertence<X, I, Ids...>
+{
+  static constexpr bool valor = (X==I) || Pertence<X, Ids...>::valor;
+};
+
+// valor == true se todas as origens IdOrig sao entradas do circuito (de -1 a -NI)
+// ou portas entre as jah avaliadas
+template<int NI, typename Avaliadas, int... IdOrig>
+struct OrigensValidas
+{
+  static constexpr bool valor = true;
+};
+template<int NI, int... Av, int O, int... Resto>
+struct OrigensValidas<NI, ListaIds<Av...>, O, Resto...>
+{
+  static constexpr bool valor = ((O<=-1 && O>=-NI) || (O>=1 && Pertence<O, Av...>::valor)) &&
+                                OrigensValidas<NI, ListaIds<Av...>, Resto...>::valor;
+};
+
+// valor == true se todas as origens IdOrig sao entradas do circuito ou portas (de 1 a NP)
+template<int NI, int NP, int... IdOrig>
+struct SaidasValidas
+{
+  static constexpr bool valor = true;
+};
+template<int NI, int NP, int O, int... Resto>
+struct SaidasValidas<NI, NP, O, Resto...>
+{
+  static constexpr bool valor = ((O<=-1 && O>=-NI) || (O>=1 && O<=NP)) &&
+                                SaidasValidas<NI, NP, Resto...>::valor;
+};
+
+// Confere as portas, na ordem em que sao avaliadas
+template<int NI, int NP, typename Avaliadas, typename... Portas>
+struct VerificarPortas
+{
+  static constexpr bool valor = true;
+};
+template<int NI, int NP, int... Av, int Id, TipoPorta T, int... IdOrig, typename... Resto>
+struct VerificarPortas<NI, NP, ListaIds<Av...>, PortaFixa<Id, T, IdOrig...>, Resto...>
+{
+  static_assert(Id>=1 && Id<=NP, "PortaFixa: invalid IdPort");
+  static_assert(!Pertence<Id, Av...>::valor, "PortaFixa: repeated IdPort");
+  static_assert((T==TipoPorta::NT && sizeof...(IdOrig)==1) ||
+                (T!=TipoPorta::NT && sizeof...(IdOrig)>=2), "PortaFixa: invalid number of inputs");
+  static_assert(OrigensValidas<NI, ListaIds<Av...>, IdOrig...>::valor,
+                "PortaFixa: invalid IdOrig (or port not yet evaluated)");
+  static constexpr bool valor = VerificarPortas<NI, NP, ListaIds<Av..., Id>, Resto...>::valor;
+};
+
+// A operacao basica de uma porta do tipo T sobre dois valores (bool3S ou bool3S64)
+template<TipoPorta T, typename V>
+inline V combinar(V a, V b)
+{
+  return (T==TipoPorta::AN || T==TipoPorta::NA) ? (a & b) :
+         (T==TipoPorta::OR || T==TipoPorta::NO) ? (a | b) : (a ^ b);
+}
+
+// A saida de uma porta do tipo T, antes da eventual inversao, a partir dos valores dos sinais
+// v (indexados por IdOrig)
+template<typename V, TipoPorta T, int... IdOrig>
+struct Combinar;
+template<typename V, TipoPorta T, int O>
+struct Combinar<V, T, O>
+{
+  static V aplicar(const V* v)
+  {
+    return v[O];
+  }
+};
+template<typename V, TipoPorta T, int O1, int O2, int... Resto>
+struct Combinar<V, T, O1, O2, Resto...>
+{
+  static V aplicar(const V* v)
+  {
+    return combinar<T>(v[O1], Combinar<V, T, O2, Resto...>::aplicar(v));
+  }
+};
+
+// Avalia as portas, em ordem, guardando suas saidas em v (indexado por IdOrig)
+template<typename V, typename... Portas>
+struct AvaliarPortas
+{
+  static void aplicar(V*)
+  {
+  }
+};
+template<typename V, int Id, TipoPorta T, int... IdOrig, typename... Resto>
+struct AvaliarPortas<V, PortaFixa<Id, T, IdOrig...>, Resto...>
+{
+  static void aplicar(V* v)
+  {
+    V res = Combinar<V, T, IdOrig...>::aplicar(v);
+    v[Id] = (T==TipoPorta::NT || T==TipoPorta::NA || T==TipoPorta::NO || T==TipoPorta::NX) ? ~res : res;
+    AvaliarPortas<V, Resto...>::aplicar(v);
+  }
+};
+
+// Copia os valores das saidas de v (indexado por IdOrig) para out[0], out[1], ...
+template<typename V, int... IdOrig>
+struct CopiarSaidas
+{
+  static void aplicar(const V*, V*)
+  {
+  }
+};
+template<typename V, int O, int... Resto>
+struct CopiarSaidas<V, O, Resto...>
+{
+  static void aplicar(const V* v, V* out)
+  {
+    out[0] = v[O];
+    CopiarSaidas<V, Resto...>::aplicar(v, out+1);
+  }
+};
+
+// Define as portas de um Circuito
+template<typename... Portas>
+struct DefinirPortas
+{
+  static void aplicar(Circuito&)
+  {
+  }
+};
+template<int Id, TipoPorta T, int... IdOrig, typename... Resto>
+struct DefinirPortas<PortaFixa<Id, T, IdOrig...>, Resto...>
+{
+  static void aplicar(Circuito& C)
+  {
+    const int orig[] = {IdOrig...};
+    C.setPort(Id, toSigla(T), int(sizeof...(IdOrig)));
+    for (int I=0; I<int(sizeof...(IdOrig)); ++I) C.setIdInPort(Id, I, orig[I]);
+    DefinirPortas<Resto...>::aplicar(C);
+  }
+};
+
+} // namespace circuito_fixo
+
+///
+/// CLASSE CIRCUITOFIXO
+///
+
+template<int NI, typename Saidas, typename... Portas>
+class CircuitoFixo;
+
+template<int NI, int... IdOut, typename... Portas>
+class CircuitoFixo<NI, SaidasFixas<IdOut...>, Portas...>
+{
+public:
+  static constexpr int NumInputs = NI;
+  static constexpr int NumOutputs = int(sizeof...(IdOut));
+  static constexpr int NumPorts = int(sizeof...(Portas));
+
+private:
+  static_assert(NumInputs>0 && NumOutputs>0 && NumPorts>0, "CircuitoFixo: invalid dimensions");
+  static_assert(circuito_fixo::VerificarPortas<NI, NumPorts, circuito_fixo::ListaIds<>, Portas...>::valor,
+                "CircuitoFixo: invalid port");
+  static_assert(circuito_fixo::SaidasValidas<NI, NumPorts, IdOut...>::valor,
+                "CircuitoFixo: invalid output IdOrig");
+
+public:
+  // Calcula as saidas do circuito: in_circ[i] eh o valor da entrada id=-(i+1) e
+  // out_circ[i] recebe o valor da saida id=i+1.
+  // V pode ser bool3S (um vetor de entrada) ou bool3S64 (64 vetores de entrada de uma soh vez).
+  template<typename V>
+  static void simular(const V* in_circ, V* out_circ)
+  {
+    // Os valores de todos os sinais, indexados por NI+IdOrig, como em Circuito
+    V valor[NI+1+NumPorts];
+    V* v = valor+NI;
+    for (int i=0; i<NI; ++i) v[-i-1] = in_circ[i];
+    circuito_fixo::AvaliarPortas<V, Portas...>::aplicar(v);
+    circuito_fixo::CopiarSaidas<V, IdOut...>::aplicar(v, out_circ);
+  }
+
+  // Retorna o circuito equivalente, com as mesmas ids de portas
+  static Circuito toCircuito()
+  {
+    Circuito C(NumInputs, NumOutputs, NumPorts);
+    circuito_fixo::DefinirPortas<Portas...>::aplicar(C);
+    const int orig[] = {IdOut...};
+    for (int id=1; id<=NumOutputs; ++id) C.setIdOutputCirc(id, orig[id-1]);
+    return C;
+  }
+};
+
+template<int NI, int... IdOut, typename... Portas>
+constexpr int CircuitoFixo<NI, SaidasFixas<IdOut...>, Portas...>::NumInputs;
+template<int NI, int... IdOut, typename... Portas>
+constexpr int CircuitoFixo<NI, SaidasFixas<IdOut...>, Portas...>::NumOutputs;
+template<int NI, int... IdOut, typename... Portas>
+constexpr int CircuitoFixo<NI, SaidasFixas<IdOut...>, Portas...>::NumPorts;
+
+// Escreve em O a declaracao de um CircuitoFixo equivalente ao circuito C, chamado Nome,
+// com as portas em ordem de avaliacao (ordem crescente de nivel).
+// Se o circuito for invalido ou tiver lacos, gera excecao.
+inline std::ostream& gerarCircuitoFixo(const Circuito& C, const std::string& Nome, std::ostream& O)
+{
+  if (!C.valid()) throw std::logic_error("gerarCircuitoFixo: invalid circuit");
+  if (!C.aciclico()) throw std::logic_error("gerarCircuitoFixo: circuit with loops");
+
+  std::vector< std::pair<int,int> > ordem;
+  for (int id=1; id<=C.getNumPorts(); ++id) ordem.push_back(std::make_pair(C.getNivelPort(id), id));
+  std::sort(ordem.begin(), ordem.end());
+
+  O << "typedef CircuitoFixo<" << C.getNumInputs() << ", SaidasFixas<";
+  for (int id=1; id<=C.getNumOutputs(); ++id)
+  {
+    O << (id>1 ? ", " : "") << C.getIdOutputCirc(id);
+  }
+  O << ">";
+  for (const auto& P : ordem)
+  {
+    int id = P.second;
+    O << ",\n    PortaFixa<" << id << ", TipoPorta::" << C.getNamePort(id);
+    for (int I=0; I<C.getNumInputsPort(id); ++I) O << ", " << C.getIdInPort(id, I);
+    O << ">";
+  }
+  O << "\n  > " << Nome << ";\n";
+  return O;
+}
+
+#endif // _CIRCUITOFIXO_H_
@@ -0,0 +1,70 @@
+#include <stdexcept>
+#include "circuitoimutavel.h"
+
+///
+/// CLASSE CIRCUITOIMUTAVEL
+///
+
+/// Compila uma copia do circuito C: valida e calcula a ordem de avaliacao.
+/// Depois disso, nenhum dado do circuito (nem os caches mutable) eh alterado.
+CircuitoImutavel::CircuitoImutavel(const Circuito& Orig)
+    : C(Orig)
+{
+  if (!C.valid()) throw std::logic_error("CircuitoImutavel: invalid circuit");
+  C.levelizar();
+}
+
+/// Calcula as saidas do circuito para o vetor de entrada in_circ, no estado E
+void CircuitoImutavel::simular(const std::vector<bool3S>& in_circ, EstadoSimulacao& E) const
+{
+  if (static_cast<int>(in_circ.size()) != getNumInputs())
+    throw std::range_error("simular: incompatible parameter size");
+  C.prepararEstado(E);
+  C.simularVetor(in_circ.data(), E);
+  C.atualizarSaidas(E);
+}
+
+/// Simulacao incremental a partir da simulacao anterior no estado E
+const std::vector<int>& CircuitoImutavel::simularIncremental(const std::vector<bool3S>& in_circ,
+                                                             EstadoSimulacao& E) const
+{
+  if (static_cast<int>(in_circ.size()) != getNumInputs())
+    throw std::range_error("simularIncremental: incompatible parameter size");
+  C.prepararEstado(E);
+  if (E.estado_ok) C.propagarEventos(in_circ.data(), E);
+  else C.simularVetor(in_circ.data(), E);
+  C.atualizarSaidas(E);
+  return E.alteradas;
+}
+
+/// Simulacao em lote no estado E
+void CircuitoImutavel::simularLote(const bool3S* in_lote, int Nvetores, bool3S* out_lote,
+                                   EstadoSimulacao& E) const
+{
+  if (Nvetores < 0 || (Nvetores > 0 && (in_lote == nullptr || out_lote == nullptr)))
+    throw std::invalid_argument("simularLote: invalid parameter(s)");
+  if (Nvetores == 0) return;
+  C.prepararEstado(E);
+  C.executarLote(in_lote, Nvetores, out_lote, false, E);
+}
+
+/// Simulacao em lote incremental no estado E
+void CircuitoImutavel::simularLoteIncremental(const bool3S* in_lote, int Nvetores, bool3S* out_lote,
+                                              EstadoSimulacao& E) const
+{
+  if (Nvetores < 0 || (Nvetores > 0 && (in_lote == nullptr || out_lote == nullptr)))
+    throw std::invalid_argument("simularLoteIncremental: invalid parameter(s)");
+  if (Nvetores == 0) return;
+  C.prepararEstado(E);
+  C.executarLote(in_lote, Nvetores, out_lote, true, E);
+}
+
+///
+/// COMPILACAO DE UM CIRCUITO
+///
+
+/// Retorna um CircuitoImutavel com uma copia deste circuito
+std::shared_ptr<const CircuitoImutavel> Circuito::compilar() const
+{
+  return std::make_shared<const CircuitoImutavel>(*this);
+}
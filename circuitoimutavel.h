@@ -0,0 +1,71 @@
+#ifndef _CIRCUITOIMUTAVEL_H_
+#define _CIRCUITOIMUTAVEL_H_
+
+#include <vector>
+#include "bool3S.h"
+#include "circuito.h"
+
+///
+/// CLASSE CIRCUITOIMUTAVEL
+///
+
+// Um circuito compilado para simulacao: validado e com a ordem de avaliacao calculada uma unica
+// vez, na construcao (ou em Circuito::compilar), e nunca mais modificado.
+// Nao guarda nenhum valor de simulacao: cada simulacao escreve apenas no EstadoSimulacao
+// passado como parametro. Assim, todas as funcoes sao const e um mesmo CircuitoImutavel pode
+// ser simulado ao mesmo tempo por varias threads (cada uma com seu proprio estado), sem que
+// cada thread precise de uma copia do circuito. O Circuito original continua podendo ser
+// editado enquanto isso.
+// Os resultados sao os mesmos das funcoes de mesmo nome de Circuito.
+class CircuitoImutavel
+{
+private:
+  // O circuito, com a ordem de avaliacao jah calculada
+  Circuito C;
+
+public:
+  // Nao existe circuito imutavel sem circuito
+  CircuitoImutavel() = delete;
+  // Compila uma copia do circuito C.
+  // Se o circuito for invalido, gera excecao.
+  explicit CircuitoImutavel(const Circuito& C);
+  // Um circuito imutavel eh compartilhado, e nao copiado
+  CircuitoImutavel(const CircuitoImutavel&) = delete;
+  CircuitoImutavel& operator=(const CircuitoImutavel&) = delete;
+
+  // O circuito compilado, apenas para consulta
+  const Circuito& getCircuito() const
+  {
+    return C;
+  }
+  int getNumInputs() const
+  {
+    return C.getNumInputs();
+  }
+  int getNumOutputs() const
+  {
+    return C.getNumOutputs();
+  }
+  int getNumPorts() const
+  {
+    return C.getNumPorts();
+  }
+
+  // Calcula as saidas do circuito para o vetor de entrada in_circ, no estado E
+  // (as saidas ficam em E.getOutputCirc).
+  // Se o parametro for invalido, gera excecao.
+  void simular(const std::vector<bool3S>& in_circ, EstadoSimulacao& E) const;
+
+  // Simulacao incremental a partir da simulacao anterior no estado E.
+  // Retorna as ids das saidas do circuito cujo valor mudou (o vetor pertence ao estado).
+  // Se o parametro for invalido, gera excecao.
+  const std::vector<int>& simularIncremental(const std::vector<bool3S>& in_circ, EstadoSimulacao& E) const;
+
+  // Simulacao em lote, completa ou incremental, no estado E (ver Circuito::simularLote).
+  // Se os parametros forem invalidos, gera excecao.
+  void simularLote(const bool3S* in_lote, int Nvetores, bool3S* out_lote, EstadoSimulacao& E) const;
+  void simularLoteIncremental(const bool3S* in_lote, int Nvetores, bool3S* out_lote,
+                              EstadoSimulacao& E) const;
+};
+
+#endif // _CIRCUITOIMUTAVEL_H_
@@ -0,0 +1,124 @@
+#include <stdexcept>
+#include <string>
+#include "construtorcircuito.h"
+
+///
+/// CLASSE CONSTRUTORCIRCUITO
+///
+
+/// Inicia a construcao de um circuito com NI entradas e NO saidas indefinidas, sem portas
+ConstrutorCircuito::ConstrutorCircuito(int NI, int NO)
+    : Nin_circ(NI),
+      estr()
+{
+  if (NI<=0 || NO<=0) throw std::invalid_argument("ConstrutorCircuito: invalid parameter(s)");
+  estr = std::make_shared<Circuito::Estrutura>();
+  estr->id_out.assign(NO, 0);
+}
+
+/// Reserva espaco para NP portas e Nconexoes conexoes
+void ConstrutorCircuito::reserve(int NP, int Nconexoes)
+{
+  if (NP<0 || Nconexoes<0) throw std::invalid_argument("reserve: invalid parameter(s)");
+  estr->tipo_port.reserve(NP);
+  estr->Nin_port.reserve(NP);
+  estr->ini_in.reserve(NP);
+  estr->id_in.reserve(Nconexoes);
+}
+
+/// Acrescenta uma porta, sem testar o numero de entradas nem as origens
+int ConstrutorCircuito::addPort(TipoPorta Tipo, const int* IdOrig, int Nin)
+{
+  if (Nin<0 || (Nin>0 && IdOrig==nullptr)) throw std::invalid_argument("addPort: invalid parameter(s)");
+  Circuito::Estrutura& Est = *estr;
+  Est.tipo_port.push_back(Tipo);
+  Est.Nin_port.push_back(Nin);
+  Est.ini_in.push_back(int(Est.id_in.size()));
+  Est.id_in.insert(Est.id_in.end(), IdOrig, IdOrig+Nin);
+  return getNumPorts();
+}
+
+/// Acrescenta NP portas de uma vez, com as origens de todas as entradas em sequencia em IdOrig
+int ConstrutorCircuito::addPorts(const TipoPorta* Tipo, const int* Nin, int NP, const int* IdOrig)
+{
+  if (NP<0 || (NP>0 && (Tipo==nullptr || Nin==nullptr)))
+    throw std::invalid_argument("addPorts: invalid parameter(s)");
+  Circuito::Estrutura& Est = *estr;
+  long long Nconexoes = 0;
+  for (int k=0; k<NP; ++k)
+  {
+    if (Nin[k]<0) throw std::invalid_argument("addPorts: invalid number of inputs");
+    Nconexoes += Nin[k];
+  }
+  if (Nconexoes>0 && IdOrig==nullptr) throw std::invalid_argument("addPorts: invalid parameter(s)");
+
+  int id0 = getNumPorts()+1;
+  Est.tipo_port.insert(Est.tipo_port.end(), Tipo, Tipo+NP);
+  Est.Nin_port.insert(Est.Nin_port.end(), Nin, Nin+NP);
+  int ini = int(Est.id_in.size());
+  Est.ini_in.reserve(Est.ini_in.size()+NP);
+  for (int k=0; k<NP; ++k)
+  {
+    Est.ini_in.push_back(ini);
+    ini += Nin[k];
+  }
+  Est.id_in.insert(Est.id_in.end(), IdOrig, IdOrig+Nconexoes);
+  return id0;
+}
+
+/// Fixa a origem de uma saida (testada apenas em construir)
+void ConstrutorCircuito::setIdOutputCirc(int IdOutput, int IdOrig)
+{
+  if (IdOutput<1 || IdOutput>getNumOutputs()) throw std::out_of_range("setIdOutputCirc: invalid IdOutput");
+  estr->id_out[IdOutput-1] = IdOrig;
+}
+
+/// Testa todo o circuito, em uma unica passagem pelas portas, conexoes e saidas,
+/// e move a estrutura construida para o circuito retornado
+Circuito ConstrutorCircuito::construir()
+{
+  const Circuito::Estrutura& Est = *estr;
+  const int NI = getNumInputs();
+  const int NP = getNumPorts();
+  if (NP == 0) throw std::logic_error("construir: circuit has no ports");
+
+  // As origens validas: as portas 1..NP e as entradas -1..-NI
+  auto valida = [NI, NP](int IdOrig) {
+    return (IdOrig>=1 && IdOrig<=NP) || (IdOrig<=-1 && IdOrig>=-NI);
+  };
+
+  for (int id=1; id<=NP; ++id)
+  {
+    TipoPorta T = Est.tipo_port[id-1];
+    int Nin = Est.Nin_port[id-1];
+    if (static_cast<int>(T) >= NUM_TIPOS_PORTA)
+      throw std::invalid_argument("construir: port "+std::to_string(id)+": invalid port type");
+    if ( (T==TipoPorta::NT && Nin!=1) || (T!=TipoPorta::NT && Nin<2) )
+      throw std::range_error("construir: port "+std::to_string(id)+" ("+toSigla(T)+"): invalid number of inputs "+
+                             std::to_string(Nin));
+    const int* orig = Est.id_in.data()+Est.ini_in[id-1];
+    for (int j=0; j<Nin; ++j)
+    {
+      if (!valida(orig[j]))
+        throw std::out_of_range("construir: port "+std::to_string(id)+", input "+std::to_string(j)+
+                                ": invalid origin "+std::to_string(orig[j]));
+    }
+  }
+  for (int id=1; id<=getNumOutputs(); ++id)
+  {
+    if (!valida(Est.id_out[id-1]))
+      throw std::out_of_range("construir: output "+std::to_string(id)+": invalid origin "+
+                              std::to_string(Est.id_out[id-1]));
+  }
+
+  // A estrutura vazia que o construtor passa a usar
+  std::shared_ptr<Circuito::Estrutura> nova = std::make_shared<Circuito::Estrutura>();
+  nova->id_out.assign(getNumOutputs(), 0);
+
+  Circuito C;
+  C.Nin_circ = NI;
+  C.estr = std::move(estr);
+  C.iniciarEstado();
+  estr = std::move(nova);
+  return C;
+}
@@ -0,0 +1,85 @@
+#ifndef _CONSTRUTORCIRCUITO_H_
+#define _CONSTRUTORCIRCUITO_H_
+
+#include <initializer_list>
+#include <memory>
+#include <vector>
+#include "porta.h"
+#include "circuito.h"
+
+///
+/// CLASSE CONSTRUTORCIRCUITO
+///
+
+// Construcao em bloco de um circuito, para geradores de circuitos grandes.
+// As portas sao acrescentadas em ordem de id (addPort), ja com o tipo e as origens de todas as
+// suas entradas, diretamente nos vetores do futuro circuito: nao ha nenhuma checagem nem
+// conversao de sigla por conexao, como em setPort e setIdInPort. As origens podem se referir a
+// portas que ainda serao acrescentadas (inclusive formando lacos).
+// Toda a validacao eh feita uma unica vez, em construir(), em uma passagem por todas as
+// conexoes; o primeiro erro encontrado gera excecao com a porta, a entrada e a origem invalidas.
+// Os vetores sao entao movidos (e nao copiados) para o circuito retornado.
+class ConstrutorCircuito
+{
+private:
+  // NUMERO DE ENTRADAS DO CIRCUITO
+  int Nin_circ;
+  // A estrutura em construcao (as portas, as conexoes e as origens das saidas)
+  std::shared_ptr<Circuito::Estrutura> estr;
+
+public:
+  // Nao existe construtor sem entradas e saidas
+  ConstrutorCircuito() = delete;
+  // Inicia a construcao de um circuito com NI entradas e NO saidas, ainda sem nenhuma porta
+  // (todas as saidas indefinidas). Se algum parametro for invalido, gera excecao.
+  ConstrutorCircuito(int NI, int NO);
+  ConstrutorCircuito(const ConstrutorCircuito&) = delete;
+  ConstrutorCircuito& operator=(const ConstrutorCircuito&) = delete;
+
+  // Reserva espaco para NP portas e Nconexoes conexoes (soma do numero de entradas das portas),
+  // evitando realocacoes durante a construcao
+  void reserve(int NP, int Nconexoes);
+
+  // Caracteristicas do circuito em construcao
+  int getNumInputs() const
+  {
+    return Nin_circ;
+  }
+  int getNumOutputs() const
+  {
+    return int(estr->id_out.size());
+  }
+  int getNumPorts() const
+  {
+    return int(estr->tipo_port.size());
+  }
+
+  // Acrescenta uma porta do tipo Tipo, com Nin entradas cujas origens sao IdOrig[0..Nin-1].
+  // Retorna a id da nova porta (getNumPorts()).
+  // O numero de entradas e as origens soh sao testados em construir().
+  int addPort(TipoPorta Tipo, const int* IdOrig, int Nin);
+  int addPort(TipoPorta Tipo, std::initializer_list<int> IdOrig)
+  {
+    return addPort(Tipo, IdOrig.begin(), int(IdOrig.size()));
+  }
+  int addPort(TipoPorta Tipo, const std::vector<int>& IdOrig)
+  {
+    return addPort(Tipo, IdOrig.data(), int(IdOrig.size()));
+  }
+
+  // Acrescenta NP portas de uma vez: a porta k tem o tipo Tipo[k] e Nin[k] entradas, e as origens
+  // de todas as entradas estao, em sequencia, em IdOrig (a soma de Nin[k] valores).
+  // Retorna a id da primeira porta acrescentada.
+  int addPorts(const TipoPorta* Tipo, const int* Nin, int NP, const int* IdOrig);
+
+  // Fixa a origem da saida cuja id eh IdOutput (a origem soh eh testada em construir()).
+  // Se IdOutput for invalido, gera excecao.
+  void setIdOutputCirc(int IdOutput, int IdOrig);
+
+  // Testa todas as portas, conexoes e saidas e, se estiverem corretas, retorna o circuito
+  // construido. O construtor volta a ficar vazio (sem portas, com as saidas indefinidas).
+  // Se houver algum erro, gera excecao e o construtor nao eh alterado.
+  Circuito construir();
+};
+
+#endif // _CONSTRUTORCIRCUITO_H_
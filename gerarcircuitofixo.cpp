@@ -0,0 +1,41 @@
+// Gera a declaracao de um CircuitoFixo (circuitofixo.h) a partir de um arquivo de circuito
+// no formato de Circuito::ler. O circuito nao pode ter lacos.
+//
+// Compilacao (fora do Qt):
+// g++ -std=c++11 gerarcircuitofixo.cpp bool3S.cpp porta.cpp circuito.cpp -o gerarcircuitofixo
+// Uso: gerarcircuitofixo arquivo_circuito [nome_do_tipo] > arquivo.h
+//
+// O tipo gerado pode ser convertido de volta com toCircuito(): escrever o circuito convertido
+// produz o mesmo arquivo de entrada.
+
+#include <iostream>
+#include <string>
+#include "circuitofixo.h"
+
+using namespace std;
+
+int main(int argc, char** argv)
+{
+  if (argc < 2 || argc > 3)
+  {
+    cerr << "Uso: " << argv[0] << " arquivo_circuito [nome_do_tipo]\n";
+    return 1;
+  }
+  string nome = (argc == 3 ? argv[2] : "CircuitoGerado");
+
+  try
+  {
+    Circuito C;
+    C.ler(argv[1]);
+
+    cout << "// Gerado por gerarcircuitofixo a partir de " << argv[1] << "\n";
+    cout << "#include \"circuitofixo.h\"\n\n";
+    gerarCircuitoFixo(C, nome, cout);
+  }
+  catch (const exception& E)
+  {
+    cerr << "Erro: " << E.what() << '\n';
+    return 1;
+  }
+  return 0;
+}
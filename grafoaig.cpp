@@ -0,0 +1,253 @@
+#include <stdexcept>
+#include <algorithm>
+#include "grafoaig.h"
+
+///
+/// CLASSE GRAFOAIG
+///
+
+/// ***********************
+/// Construcao
+/// ***********************
+
+/// Retorna o literal de uma porta AND com entradas a e b, criando a porta se ainda nao existir
+int GrafoAIG::novoE(int a, int b)
+{
+  // a & a = a (tambem em 3 estados); a & ~a eh mantido (pode ser UNDEF)
+  if (a == b) return a;
+  if (a > b) std::swap(a, b);
+  uint64_t chave = (uint64_t(uint32_t(a)) << 32) | uint32_t(b);
+  auto it = tabela.find(chave);
+  if (it != tabela.end())
+  {
+    ++Nunificadas;
+    return literal(it->second, false);
+  }
+  int No = Nin_circ + int(esq.size());
+  esq.push_back(a);
+  dir.push_back(b);
+  tabela.insert(std::make_pair(chave, No));
+  return literal(No, false);
+}
+
+/// Converte o circuito C para um AIG.
+/// Se o circuito for invalido ou tiver lacos, gera excecao.
+GrafoAIG::GrafoAIG(const Circuito& C)
+    : Nin_circ(C.getNumInputs()),
+      esq(),
+      dir(),
+      lit_out(),
+      tabela(),
+      Nunificadas(0),
+      valor(),
+      valor64()
+{
+  if (!C.valid()) throw std::logic_error("GrafoAIG: invalid circuit");
+  if (!C.aciclico()) throw std::logic_error("GrafoAIG: circuit with loops");
+
+  int NP = C.getNumPorts();
+  int id, j;
+
+  // Ordem topologica: as portas em ordem crescente de nivel
+  int Nniveis = C.getProfundidade();
+  std::vector< std::vector<int> > por_nivel(Nniveis+1);
+  for (id=1; id<=NP; ++id) por_nivel.at(C.getNivelPort(id)).push_back(id);
+
+  // O literal da saida de cada porta
+  std::vector<int> lit_port(NP+1, 0);
+  auto lit = [&](int IdOrig)
+  {
+    return (IdOrig>0 ? lit_port.at(IdOrig) : literal(-IdOrig-1, false));
+  };
+
+  std::vector<int> L;
+  for (const auto& nivel : por_nivel)
+  {
+    for (int id : nivel)
+    {
+      TipoPorta T = toTipoPorta(C.getNamePort(id));
+      L.clear();
+      for (j=0; j<C.getNumInputsPort(id); ++j) L.push_back(lit(C.getIdInPort(id,j)));
+      // As operacoes sao associativas e comutativas: ordenar as entradas
+      // aumenta as chances de unificacao
+      std::sort(L.begin(), L.end());
+
+      int res = L[0];
+      switch (T)
+      {
+      case TipoPorta::NT:
+        res = inverter(res);
+        break;
+      case TipoPorta::AN:
+      case TipoPorta::NA:
+        for (j=1; j<int(L.size()); ++j) res = novoE(res, L[j]);
+        break;
+      case TipoPorta::OR:
+      case TipoPorta::NO:
+        for (j=1; j<int(L.size()); ++j) res = novoOU(res, L[j]);
+        break;
+      case TipoPorta::XO:
+      case TipoPorta::NX:
+      default:
+        for (j=1; j<int(L.size()); ++j) res = novoXOU(res, L[j]);
+        break;
+      }
+      if (T==TipoPorta::NA || T==TipoPorta::NO || T==TipoPorta::NX) res = inverter(res);
+      lit_port.at(id) = res;
+    }
+  }
+
+  for (id=1; id<=C.getNumOutputs(); ++id) lit_out.push_back(lit(C.getIdOutputCirc(id)));
+
+  valor.resize(Nin_circ+esq.size(), bool3S::UNDEF);
+  valor64.resize(Nin_circ+esq.size());
+}
+
+/// ***********************
+/// SIMULACAO
+/// ***********************
+
+/// Calcula as saidas do circuito para os valores de entrada passados como parametro
+void GrafoAIG::simular(const std::vector<bool3S>& in_circ)
+{
+  if (static_cast<int>(in_circ.size()) != getNumInputs())
+    throw std::range_error("simular: incompatible parameter size");
+
+  bool3S* V = valor.data();
+  for (int i=0; i<Nin_circ; ++i) V[i] = in_circ[i];
+  const int NE = getNumPortasE();
+  for (int k=0; k<NE; ++k)
+  {
+    bool3S a = V[no(esq[k])];
+    bool3S b = V[no(dir[k])];
+    if (invertido(esq[k])) a = ~a;
+    if (invertido(dir[k])) b = ~b;
+    V[Nin_circ+k] = a & b;
+  }
+}
+
+/// Retorna a saida do circuito cuja id eh IdOutput na ultima chamada a simular.
+bool3S GrafoAIG::getOutputCirc(int IdOutput) const
+{
+  if (IdOutput<1 || IdOutput>getNumOutputs()) throw std::out_of_range("getOutputCirc: invalid ID");
+  int Lit = lit_out[IdOutput-1];
+  return (invertido(Lit) ? ~valor[no(Lit)] : valor[no(Lit)]);
+}
+
+/// Calcula as saidas do circuito para 64 vetores de entrada de uma soh vez
+void GrafoAIG::simular(const std::vector<bool3S64>& in_circ)
+{
+  if (static_cast<int>(in_circ.size()) != getNumInputs())
+    throw std::range_error("simular: incompatible parameter size");
+
+  bool3S64* V = valor64.data();
+  for (int i=0; i<Nin_circ; ++i) V[i] = in_circ[i];
+  const int NE = getNumPortasE();
+  for (int k=0; k<NE; ++k)
+  {
+    bool3S64 a = V[no(esq[k])];
+    bool3S64 b = V[no(dir[k])];
+    if (invertido(esq[k])) a = ~a;
+    if (invertido(dir[k])) b = ~b;
+    V[Nin_circ+k] = a & b;
+  }
+}
+
+/// Retorna os 64 valores da saida do circuito cuja id eh IdOutput na ultima chamada a simular.
+bool3S64 GrafoAIG::getOutputCirc64(int IdOutput) const
+{
+  if (IdOutput<1 || IdOutput>getNumOutputs()) throw std::out_of_range("getOutputCirc: invalid ID");
+  int Lit = lit_out[IdOutput-1];
+  return (invertido(Lit) ? ~valor64[no(Lit)] : valor64[no(Lit)]);
+}
+
+/// ***********************
+/// Conversao para Circuito
+/// ***********************
+
+/// Converte o AIG de volta para um Circuito.
+/// Cada porta AND vira uma porta AN; se ela soh for usada invertida, vira uma porta NA.
+/// Cada no usado invertido (e que nao virou NA) ganha uma unica porta NT.
+Circuito GrafoAIG::toCircuito() const
+{
+  const int Nnos = Nin_circ + getNumPortasE();
+  int k;
+
+  // Os nos que alcancam alguma saida e quantas vezes cada no eh usado direto e invertido
+  std::vector<char> vivo(Nnos, 0);
+  std::vector<int> Ndireto(Nnos, 0), Ninvertido(Nnos, 0);
+  for (int Lit : lit_out) vivo[no(Lit)] = 1;
+  for (k=getNumPortasE()-1; k>=0; --k)
+  {
+    if (!vivo[Nin_circ+k]) continue;
+    vivo[no(esq[k])] = vivo[no(dir[k])] = 1;
+  }
+  auto contar = [&](int Lit)
+  {
+    if (invertido(Lit)) ++Ninvertido[no(Lit)];
+    else ++Ndireto[no(Lit)];
+  };
+  for (int Lit : lit_out) contar(Lit);
+  for (k=0; k<getNumPortasE(); ++k)
+  {
+    if (!vivo[Nin_circ+k]) continue;
+    contar(esq[k]);
+    contar(dir[k]);
+  }
+
+  // As ids das portas do novo circuito: id_direto[no] eh a origem do valor do no e
+  // id_invertido[no] a origem do valor invertido (0 se nao for usado)
+  std::vector<int> id_direto(Nnos, 0), id_invertido(Nnos, 0);
+  std::vector<char> eh_NA(Nnos, 0);
+  int NP = 0;
+  for (k=0; k<Nnos; ++k)
+  {
+    if (k < Nin_circ) id_direto[k] = -(k+1);
+    if (!vivo[k]) continue;
+    if (k >= Nin_circ)
+    {
+      if (Ndireto[k]==0 && Ninvertido[k]>0)
+      {
+        eh_NA[k] = 1;
+        id_invertido[k] = ++NP;
+        continue;
+      }
+      id_direto[k] = ++NP;
+    }
+    if (Ninvertido[k] > 0) id_invertido[k] = ++NP;
+  }
+  auto origem = [&](int Lit)
+  {
+    return (invertido(Lit) ? id_invertido[no(Lit)] : id_direto[no(Lit)]);
+  };
+
+  // Um circuito deve ter pelo menos uma porta: se nenhuma for necessaria, cria uma NT
+  Circuito C(Nin_circ, getNumOutputs(), std::max(NP, 1));
+  if (NP == 0)
+  {
+    C.setPort(1, "NT", 1);
+    C.setIdInPort(1, 0, -1);
+  }
+  for (k=0; k<Nnos; ++k)
+  {
+    if (!vivo[k]) continue;
+    if (k >= Nin_circ)
+    {
+      int Id = (eh_NA[k] ? id_invertido[k] : id_direto[k]);
+      C.setPort(Id, eh_NA[k] ? "NA" : "AN", 2);
+      C.setIdInPort(Id, 0, origem(esq[k-Nin_circ]));
+      C.setIdInPort(Id, 1, origem(dir[k-Nin_circ]));
+      if (eh_NA[k]) continue;
+    }
+    if (id_invertido[k] != 0)
+    {
+      C.setPort(id_invertido[k], "NT", 1);
+      C.setIdInPort(id_invertido[k], 0, id_direto[k]);
+    }
+  }
+  for (int IdOutput=1; IdOutput<=getNumOutputs(); ++IdOutput)
+  {
+    C.setIdOutputCirc(IdOutput, origem(lit_out[IdOutput-1]));
+  }
+  return C;
+}
@@ -0,0 +1,140 @@
+#ifndef _GRAFOAIG_H_
+#define _GRAFOAIG_H_
+
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+#include "bool3S.h"
+#include "bool3S64.h"
+#include "circuito.h"
+
+///
+/// CLASSE GRAFOAIG
+///
+
+// Um grafo AND-inversor (AIG): um circuito em que todos os nos sao portas AND de 2 entradas
+// e as inversoes ficam nas ligacoes.
+// Os nos 0..Nin_circ-1 sao as entradas do circuito (entrada id=-(i+1) -> no i) e os nos
+// seguintes sao as portas AND. Cada ligacao eh um literal: 2*no (o valor do no) ou
+// 2*no+1 (o valor do no invertido).
+// Como as operacoes de bool3S satisfazem as leis de De Morgan e sao associativas e comutativas,
+// as portas do Circuito sao traduzidas sem mudar a semantica de 3 estados:
+// OR(a,b) = ~(~a & ~b) e XOR(a,b) = ~(~(a & ~b) & ~(~a & b)).
+// a & ~a NAO eh simplificado para FALSE: se a for UNDEF, o resultado eh UNDEF.
+//
+// Durante a construcao, as portas AND estruturalmente iguais (mesmo par de literais de entrada)
+// sao unificadas por uma tabela hash, eliminando a logica duplicada.
+// Soh circuitos sem lacos podem ser convertidos.
+class GrafoAIG
+{
+private:
+  // NUMERO DE ENTRADAS DO CIRCUITO
+  int Nin_circ;
+
+  // AS PORTAS AND: a porta k (no Nin_circ+k) tem entradas esq[k] e dir[k] (literais, esq<=dir)
+  std::vector<int> esq;
+  std::vector<int> dir;
+  // O literal de cada saida do circuito
+  std::vector<int> lit_out;
+
+  // A tabela hash das portas AND: par de literais -> no
+  std::unordered_map<uint64_t,int> tabela;
+  // O numero de portas AND unificadas pela tabela hash
+  int Nunificadas;
+
+  // Os valores de todos os nos na ultima simulacao
+  std::vector<bool3S> valor;
+  std::vector<bool3S64> valor64;
+
+  // Retorna o literal de uma porta AND com entradas a e b, criando a porta se ainda nao existir
+  int novoE(int a, int b);
+  // Retorna o literal de a OR b e de a XOR b
+  int novoOU(int a, int b)
+  {
+    return inverter(novoE(inverter(a), inverter(b)));
+  }
+  int novoXOU(int a, int b)
+  {
+    return inverter(novoE(inverter(novoE(a, inverter(b))), inverter(novoE(inverter(a), b))));
+  }
+
+public:
+  // Os literais
+  static int literal(int No, bool Inv)
+  {
+    return 2*No + (Inv ? 1 : 0);
+  }
+  static int inverter(int Lit)
+  {
+    return Lit ^ 1;
+  }
+  static int no(int Lit)
+  {
+    return Lit >> 1;
+  }
+  static bool invertido(int Lit)
+  {
+    return (Lit & 1) != 0;
+  }
+
+  // Nao existe grafo sem circuito
+  GrafoAIG() = delete;
+  // Converte o circuito C para um AIG.
+  // Se o circuito for invalido ou tiver lacos, gera excecao.
+  explicit GrafoAIG(const Circuito& C);
+
+  int getNumInputs() const
+  {
+    return Nin_circ;
+  }
+  int getNumOutputs() const
+  {
+    return int(lit_out.size());
+  }
+  // O numero de portas AND
+  int getNumPortasE() const
+  {
+    return int(esq.size());
+  }
+  // O numero de portas AND que foram unificadas com outra igual durante a construcao
+  int getNumUnificadas() const
+  {
+    return Nunificadas;
+  }
+  // Os literais de entrada da porta AND k (de 0 a getNumPortasE()-1) e o literal da saida IdOutput
+  // Gera excecao se o parametro for invalido.
+  int getEsq(int k) const
+  {
+    return esq.at(k);
+  }
+  int getDir(int k) const
+  {
+    return dir.at(k);
+  }
+  int getLitOutput(int IdOutput) const
+  {
+    return lit_out.at(IdOutput-1);
+  }
+
+  // Calcula as saidas do circuito para os valores de entrada passados como parametro
+  // (a mesma interface de Circuito::simular).
+  // Se o parametro for invalido, gera excecao.
+  void simular(const std::vector<bool3S>& in_circ);
+  // Retorna a saida do circuito cuja id eh IdOutput na ultima chamada a simular.
+  // Gera excecao se o parametro for invalido.
+  bool3S getOutputCirc(int IdOutput) const;
+
+  // Calcula as saidas do circuito para 64 vetores de entrada de uma soh vez
+  // (o k-esimo valor de in_circ.at(i) eh o valor da entrada id=-(i+1) no k-esimo vetor).
+  // Se o parametro for invalido, gera excecao.
+  void simular(const std::vector<bool3S64>& in_circ);
+  // Retorna os 64 valores da saida do circuito cuja id eh IdOutput na ultima chamada a simular.
+  // Gera excecao se o parametro for invalido.
+  bool3S64 getOutputCirc64(int IdOutput) const;
+
+  // Converte o AIG de volta para um Circuito (portas AN, NA e NT), apenas com as
+  // portas que alcancam alguma saida.
+  Circuito toCircuito() const;
+};
+
+#endif // _GRAFOAIG_H_
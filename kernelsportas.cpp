@@ -0,0 +1,60 @@
+#include "kernelsportas.h"
+#include "kernelsportas_impl.h"
+
+///
+/// KERNEL ESCALAR (portatil)
+///
+
+namespace {
+
+// Um "registrador" com uma palavra de 64 bits
+struct VetEscalar
+{
+  static const int N = 1;
+  uint64_t x;
+
+  static VetEscalar load(const uint64_t* p) { VetEscalar v; v.x = *p; return v; }
+  static void store(uint64_t* p, VetEscalar v) { *p = v.x; }
+  static VetEscalar e(VetEscalar a, VetEscalar b) { a.x &= b.x; return a; }
+  static VetEscalar ou(VetEscalar a, VetEscalar b) { a.x |= b.x; return a; }
+  static bool igual(VetEscalar a, VetEscalar b) { return a.x == b.x; }
+};
+
+const KernelPortas kernel_escalar = {"escalar", VetEscalar::N, &avaliarPortas<VetEscalar>};
+
+} // namespace
+
+// Os kernels vetoriais (definidos em kernelsportas_avx2.cpp e kernelsportas_avx512.cpp)
+// Retornam nullptr se o compilador ou a arquitetura nao permitirem gerar o kernel.
+const KernelPortas* kernelAVX2();
+const KernelPortas* kernelAVX512();
+
+///
+/// ESCOLHA DO KERNEL
+///
+
+const KernelPortas& kernelEscalar()
+{
+  return kernel_escalar;
+}
+
+const std::vector<const KernelPortas*>& kernelsDisponiveis()
+{
+  // Consulta o processador (CPUID) apenas uma vez
+  static const std::vector<const KernelPortas*> disponiveis = []()
+  {
+    std::vector<const KernelPortas*> K(1, &kernel_escalar);
+#if (defined(__GNUC__) || defined(__clang__)) && (defined(__x86_64__) || defined(__i386__))
+    __builtin_cpu_init();
+    if (kernelAVX2()!=nullptr && __builtin_cpu_supports("avx2")) K.push_back(kernelAVX2());
+    if (kernelAVX512()!=nullptr && __builtin_cpu_supports("avx512f")) K.push_back(kernelAVX512());
+#endif
+    return K;
+  }();
+  return disponiveis;
+}
+
+const KernelPortas& kernelPortas()
+{
+  return *kernelsDisponiveis().back();
+}
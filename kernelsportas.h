@@ -0,0 +1,48 @@
+#ifndef _KERNELSPORTAS_H_
+#define _KERNELSPORTAS_H_
+
+#include <cstdint>
+#include <vector>
+#include "porta.h"
+
+///
+/// KERNELS DE AVALIACAO DE PORTAS SOBRE BLOCOS DE PADROES
+///
+
+// Um kernel eh um conjunto de rotinas que avalia portas logicas sobre blocos de padroes
+// de simulacao na forma dual-rail (ver bool3S64.h).
+// Cada bloco tem Npalavras palavras de 64 bits por trilho, ou seja, 64*Npalavras padroes.
+// O sinal s ocupa 2*Npalavras palavras consecutivas do vetor de sinais:
+// - sinais[2*Npalavras*s + w]: palavra w do trilho f ("pode ser FALSE")
+// - sinais[2*Npalavras*s + Npalavras + w]: palavra w do trilho t ("pode ser TRUE")
+//
+// Existem versoes escalar (portatil, 64 padroes), AVX2 (256 padroes) e AVX-512 (512 padroes).
+// As versoes vetoriais soh sao oferecidas se o processador em uso tiver as instrucoes
+// correspondentes, o que eh verificado via CPUID na primeira consulta.
+struct KernelPortas
+{
+  // O nome do kernel: "escalar", "avx2" ou "avx512"
+  const char* nome;
+  // O numero de palavras de 64 bits por trilho em cada bloco (1, 4 ou 8)
+  int Npalavras;
+  // Avalia, em sequencia, as portas de indices k0 a k1-1:
+  // a k-esima porta eh do tipo tipo[k], tem saida no sinal sinal_port[k] e
+  // entradas nos sinais sinal_in[ini_in[k]..ini_in[k+1]-1].
+  // Se "comparar" for true, retorna true se a saida de alguma porta mudou.
+  // Se "comparar" for false, retorna sempre false.
+  bool (*avaliar)(const TipoPorta* tipo, const int* sinal_port,
+                  const int* ini_in, const int* sinal_in,
+                  int k0, int k1, uint64_t* sinais, bool comparar);
+};
+
+// Retorna o kernel escalar portatil (64 padroes por bloco), disponivel em qualquer processador
+const KernelPortas& kernelEscalar();
+
+// Retorna todos os kernels que podem ser usados no processador em uso,
+// do mais simples (escalar) ao mais largo
+const std::vector<const KernelPortas*>& kernelsDisponiveis();
+
+// Retorna o kernel mais largo que pode ser usado no processador em uso
+const KernelPortas& kernelPortas();
+
+#endif // _KERNELSPORTAS_H_
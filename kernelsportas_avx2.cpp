@@ -0,0 +1,53 @@
+#include "kernelsportas.h"
+
+///
+/// KERNEL AVX2 (256 padroes por bloco)
+///
+
+// Apenas as funcoes definidas a partir daqui usam instrucoes AVX2; o kernel soh eh
+// escolhido em tempo de execucao se o processador tiver essas instrucoes.
+#if (defined(__GNUC__) || defined(__clang__)) && (defined(__x86_64__) || defined(__i386__))
+
+#pragma GCC push_options
+#pragma GCC target("avx2")
+#include <immintrin.h>
+#include "kernelsportas_impl.h"
+
+namespace {
+
+// Um registrador AVX2 com 4 palavras de 64 bits
+struct VetAVX2
+{
+  static const int N = 4;
+  __m256i x;
+
+  static VetAVX2 load(const uint64_t* p) { VetAVX2 v; v.x = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p)); return v; }
+  static void store(uint64_t* p, VetAVX2 v) { _mm256_storeu_si256(reinterpret_cast<__m256i*>(p), v.x); }
+  static VetAVX2 e(VetAVX2 a, VetAVX2 b) { a.x = _mm256_and_si256(a.x, b.x); return a; }
+  static VetAVX2 ou(VetAVX2 a, VetAVX2 b) { a.x = _mm256_or_si256(a.x, b.x); return a; }
+  static bool igual(VetAVX2 a, VetAVX2 b)
+  {
+    __m256i d = _mm256_xor_si256(a.x, b.x);
+    return _mm256_testz_si256(d, d) != 0;
+  }
+};
+
+const KernelPortas kernel_avx2 = {"avx2", VetAVX2::N, &avaliarPortas<VetAVX2>};
+
+} // namespace
+
+#pragma GCC pop_options
+
+const KernelPortas* kernelAVX2()
+{
+  return &kernel_avx2;
+}
+
+#else
+
+const KernelPortas* kernelAVX2()
+{
+  return nullptr;
+}
+
+#endif
@@ -0,0 +1,49 @@
+#include "kernelsportas.h"
+
+///
+/// KERNEL AVX-512 (512 padroes por bloco)
+///
+
+// Apenas as funcoes definidas a partir daqui usam instrucoes AVX-512; o kernel soh eh
+// escolhido em tempo de execucao se o processador tiver essas instrucoes.
+#if (defined(__GNUC__) || defined(__clang__)) && (defined(__x86_64__) || defined(__i386__))
+
+#pragma GCC push_options
+#pragma GCC target("avx512f")
+#include <immintrin.h>
+#include "kernelsportas_impl.h"
+
+namespace {
+
+// Um registrador AVX-512 com 8 palavras de 64 bits
+struct VetAVX512
+{
+  static const int N = 8;
+  __m512i x;
+
+  static VetAVX512 load(const uint64_t* p) { VetAVX512 v; v.x = _mm512_loadu_si512(p); return v; }
+  static void store(uint64_t* p, VetAVX512 v) { _mm512_storeu_si512(p, v.x); }
+  static VetAVX512 e(VetAVX512 a, VetAVX512 b) { a.x = _mm512_and_si512(a.x, b.x); return a; }
+  static VetAVX512 ou(VetAVX512 a, VetAVX512 b) { a.x = _mm512_or_si512(a.x, b.x); return a; }
+  static bool igual(VetAVX512 a, VetAVX512 b) { return _mm512_cmpneq_epi64_mask(a.x, b.x) == 0; }
+};
+
+const KernelPortas kernel_avx512 = {"avx512", VetAVX512::N, &avaliarPortas<VetAVX512>};
+
+} // namespace
+
+#pragma GCC pop_options
+
+const KernelPortas* kernelAVX512()
+{
+  return &kernel_avx512;
+}
+
+#else
+
+const KernelPortas* kernelAVX512()
+{
+  return nullptr;
+}
+
+#endif
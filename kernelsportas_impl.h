@@ -0,0 +1,95 @@
+#ifndef _KERNELSPORTAS_IMPL_H_
+#define _KERNELSPORTAS_IMPL_H_
+
+// Implementacao generica dos kernels de avaliacao de portas.
+// Esse arquivo soh deve ser incluido pelos arquivos kernelsportas*.cpp.
+// O parametro V deve ser uma classe que representa um registrador com V::N palavras de 64 bits:
+//   static V load(const uint64_t* p);
+//   static void store(uint64_t* p, V x);
+//   static V e(V a, V b);     // AND bit a bit
+//   static V ou(V a, V b);    // OR bit a bit
+//   static bool igual(V a, V b);
+
+#include <cstdint>
+#include "porta.h"
+
+namespace {
+
+template <class V>
+bool avaliarPortas(const TipoPorta* tipo, const int* sinal_port,
+                   const int* ini_in, const int* sinal_in,
+                   int k0, int k1, uint64_t* sinais, bool comparar)
+{
+  const int W = V::N;
+  const int S = 2*W;
+  bool mudou = false;
+
+  for (int k=k0; k<k1; ++k)
+  {
+    const int* in = sinal_in + ini_in[k];
+    const int Nin = ini_in[k+1] - ini_in[k];
+    const uint64_t* p = sinais + S*in[0];
+    V f = V::load(p);
+    V t = V::load(p+W);
+    int j;
+
+    switch (tipo[k])
+    {
+    case TipoPorta::AN:
+    case TipoPorta::NA:
+      for (j=1; j<Nin; ++j)
+      {
+        p = sinais + S*in[j];
+        f = V::ou(f, V::load(p));
+        t = V::e(t, V::load(p+W));
+      }
+      break;
+    case TipoPorta::OR:
+    case TipoPorta::NO:
+      for (j=1; j<Nin; ++j)
+      {
+        p = sinais + S*in[j];
+        f = V::e(f, V::load(p));
+        t = V::ou(t, V::load(p+W));
+      }
+      break;
+    case TipoPorta::XO:
+    case TipoPorta::NX:
+      for (j=1; j<Nin; ++j)
+      {
+        p = sinais + S*in[j];
+        V f2 = V::load(p);
+        V t2 = V::load(p+W);
+        V nf = V::ou(V::e(f, f2), V::e(t, t2));
+        t = V::ou(V::e(f, t2), V::e(t, f2));
+        f = nf;
+      }
+      break;
+    case TipoPorta::NT:
+    default:
+      break;
+    }
+
+    // As portas inversoras trocam os trilhos
+    if (tipo[k]==TipoPorta::NT || tipo[k]==TipoPorta::NA ||
+        tipo[k]==TipoPorta::NO || tipo[k]==TipoPorta::NX)
+    {
+      V prov = f;
+      f = t;
+      t = prov;
+    }
+
+    uint64_t* d = sinais + S*sinal_port[k];
+    if (comparar && !mudou)
+    {
+      mudou = !V::igual(f, V::load(d)) || !V::igual(t, V::load(d+W));
+    }
+    V::store(d, f);
+    V::store(d+W, t);
+  }
+  return mudou;
+}
+
+} // namespace
+
+#endif // _KERNELSPORTAS_IMPL_H_
@@ -4,6 +4,8 @@
 #include <QString>
 #include <QFileDialog>
 #include <QMessageBox>
+#include <memory>
+#include "tabelaverdade.h"
 
 MainCircuito::MainCircuito(QWidget *parent) :
   QMainWindow(parent),
@@ -451,38 +453,49 @@ void MainCircuito::on_actionGerar_tabela_triggered()
   int numInputs = C.getNumInputs();
   int numOutputs = C.getNumOutputs();
 
-  // vector com as "numInputs" entradas do circuito,
-  // a serem geradas consecutivamente com todas as combinacoes de entrada.
-  // Comeca com todas as entradas bool3S::UNDEF
-  std::vector<bool3S> in_circ(numInputs, bool3S::UNDEF);
+  // A tabela verdade soh pode ser gerada para um numero limitado de entradas
+  if (numInputs > TabelaVerdade::MAX_ENTRADAS)
+  {
+    QMessageBox::critical(this, "Erro de simulacao", "O Circuito tem "+QString::number(numInputs)+
+                          " entradas.\nA tabela verdade pode ser gerada para no maximo "+
+                          QString::number(TabelaVerdade::MAX_ENTRADAS)+" entradas.");
+    return;
+  }
 
-  // Linha na tabela verdade (comeca de 1 e nao de 0,
-  // pois a 1a linha eh o pseudocabecalho)
-  int linha=1;
+  // Calcula todas as linhas da tabela verdade (em paralelo, com todos os processadores)
+  std::unique_ptr<TabelaVerdade> ptrT;
+  try
+  {
+    ptrT.reset(new TabelaVerdade(C));
+  }
+  catch(std::exception& E)
+  {
+    // Exibe uma msg de erro na simulacao (p.ex. falta de memoria para a tabela)
+    QMessageBox::critical(this, "Erro de simulacao", QString("Erro ao gerar a tabela verdade:\n")+E.what());
+    return;
+  }
+  const TabelaVerdade& T = *ptrT;
 
   // Variaveis auxiliares
   QLabel *prov;
   int i;
 
   //
-  // Gera todas as combinacoes de entrada e as linhas correspondentes da tabela verdade
+  // Exibe todas as combinacoes de entrada e as linhas correspondentes da tabela verdade
+  // (a linha L da tabela eh exibida na linha L+1, pois a 1a linha eh o pseudocabecalho)
   //
-  do
+  for (int L=0; L<T.getNumLinhas(); ++L)
   {
-    // Chama o metodo de simulacao da classe Circuito,
-    // passando como parametro o vetor de entradas atual.
-    C.simular(in_circ);
-
     //
     // Exibe as entradas
     //
     for (i=0; i<numInputs; ++i)
     {
       // Exibe o valor de cada uma das entradas do circuito
-      // na linha "linha" da tabela verdade, nas colunas de 0 a numInputs-1
-      prov = new QLabel( QString( toChar(in_circ.at(i)) ) );
+      // na linha "L+1" da tabela verdade, nas colunas de 0 a numInputs-1
+      prov = new QLabel( QString( toChar(T.getInput(L, -(i+1))) ) );
       prov->setAlignment(Qt::AlignCenter);
-      ui->tableTabelaVerdade->setCellWidget(linha, i, prov);
+      ui->tableTabelaVerdade->setCellWidget(L+1, i, prov);
     }
 
     //
@@ -491,28 +504,12 @@ void MainCircuito::on_actionGerar_tabela_triggered()
     for (i=0; i<numOutputs; ++i)
     {
       // Exibe o valor de cada uma das saidas do circuito
-      // na linha "linha" da tabela verdade, nas colunas de numInputs a numInputs+numOutputs-1
-      prov = new QLabel( QString( toChar(C.getOutputCirc(i+1)) ) );
+      // na linha "L+1" da tabela verdade, nas colunas de numInputs a numInputs+numOutputs-1
+      prov = new QLabel( QString( toChar(T.getOutput(L, i+1)) ) );
       prov->setAlignment(Qt::AlignCenter);
-      ui->tableTabelaVerdade->setCellWidget(linha, i+numInputs, prov);
+      ui->tableTabelaVerdade->setCellWidget(L+1, i+numInputs, prov);
     }
-
-    // Incrementa a linha da tabela para proxima exibicao
-    ++linha;
-
-    // Gera a proxima combinacao de entrada
-    // Incrementa a ultima entrada que nao for TRUE
-    // Se a ultima for TRUE, tenta incrementar a anterior
-    i = numInputs-1;
-    while (i>=0 && in_circ.at(i)==bool3S::TRUE)
-    {
-      ++in_circ.at(i);
-      --i;
-    };
-    // Incrementa a input selecionada
-    if (i>=0) ++in_circ.at(i);
-
-  } while (i>=0);
+  }
 }
 
 // Exibe a caixa de dialogo para fixar caracteristicas de uma porta
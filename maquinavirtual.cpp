@@ -0,0 +1,247 @@
+#include <stdexcept>
+#include "maquinavirtual.h"
+
+///
+/// CLASSE MAQUINAVIRTUAL
+///
+
+/// ***********************
+/// Traducao
+/// ***********************
+
+/// Traduz o circuito C para o codigo da maquina.
+/// Se o circuito for invalido, gera excecao.
+MaquinaVirtual::MaquinaVirtual(const Circuito& C)
+    : Nin_circ(C.getNumInputs()),
+      Nout_circ(C.getNumOutputs()),
+      Nports(C.getNumPorts()),
+      prog(),
+      ini_lacos(0),
+      reg(),
+      reg_lacos(),
+      ant_lacos(),
+      reg_out()
+{
+  if (!C.valid()) throw std::logic_error("MaquinaVirtual: invalid circuit");
+
+  int id, j, k;
+
+  // Ordena as portas por nivel (ordenacao por contagem), deixando ao final
+  // as portas em lacos (nivel -1), em ordem crescente de id
+  int Nniveis = C.getProfundidade();
+  std::vector<int> ini_nivel(Nniveis+2, 0);
+  for (id=1; id<=Nports; ++id)
+  {
+    int n = C.getNivelPort(id);
+    ++ini_nivel.at(n<0 ? Nniveis+1 : n);
+  }
+  for (k=1; k<=Nniveis+1; ++k) ini_nivel.at(k) += ini_nivel.at(k-1);
+  int Nacicl = ini_nivel.at(Nniveis);
+  std::vector<int> ordem(Nports);
+  for (id=Nports; id>=1; --id)
+  {
+    int n = C.getNivelPort(id);
+    ordem.at(--ini_nivel.at(n<0 ? Nniveis+1 : n)) = id;
+  }
+
+  // O registrador de cada sinal e o registrador auxiliar
+  auto registrador = [this](int IdOrig)
+  {
+    return (IdOrig>0 ? Nin_circ+IdOrig-1 : -IdOrig-1);
+  };
+  const int aux = Nin_circ+Nports;
+
+  for (k=0; k<Nports; ++k)
+  {
+    if (k == Nacicl)
+    {
+      prog.push_back({Opcode::FIM, 0, 0, 0});
+      ini_lacos = int(prog.size());
+    }
+    id = ordem.at(k);
+    TipoPorta T = toTipoPorta(C.getNamePort(id));
+    int Nin = C.getNumInputsPort(id);
+    int d = registrador(id);
+    int a = registrador(C.getIdInPort(id,0));
+
+    // A operacao final da porta e a operacao que acumula as entradas intermediarias
+    Opcode op, acum;
+    switch (T)
+    {
+    case TipoPorta::NT: op = Opcode::NT; acum = Opcode::NT; break;
+    case TipoPorta::AN: op = Opcode::AN; acum = Opcode::AN; break;
+    case TipoPorta::NA: op = Opcode::NA; acum = Opcode::AN; break;
+    case TipoPorta::OR: op = Opcode::OR; acum = Opcode::OR; break;
+    case TipoPorta::NO: op = Opcode::NO; acum = Opcode::OR; break;
+    case TipoPorta::XO: op = Opcode::XO; acum = Opcode::XO; break;
+    case TipoPorta::NX:
+    default:            op = Opcode::NX; acum = Opcode::XO; break;
+    }
+
+    if (T==TipoPorta::NT)
+    {
+      prog.push_back({Opcode::NT, d, a, a});
+    }
+    else if (Nin == 1)
+    {
+      // Porta com uma unica entrada: copia ou inverte
+      bool inv = (op != acum);
+      prog.push_back({inv ? Opcode::NT : Opcode::COPIA, d, a, a});
+    }
+    else
+    {
+      // As entradas intermediarias sao acumuladas no registrador auxiliar
+      for (j=1; j<Nin-1; ++j)
+      {
+        prog.push_back({acum, aux, a, registrador(C.getIdInPort(id,j))});
+        a = aux;
+      }
+      prog.push_back({op, d, a, registrador(C.getIdInPort(id,Nin-1))});
+    }
+  }
+  if (Nacicl == Nports)
+  {
+    prog.push_back({Opcode::FIM, 0, 0, 0});
+    ini_lacos = int(prog.size());
+  }
+  prog.push_back({Opcode::FIM, 0, 0, 0});
+
+  // Os registradores das portas em lacos
+  for (k=Nacicl; k<Nports; ++k) reg_lacos.push_back(registrador(ordem.at(k)));
+  ant_lacos.resize(reg_lacos.size());
+
+  // As origens das saidas
+  reg_out.resize(Nout_circ);
+  for (id=1; id<=Nout_circ; ++id) reg_out.at(id-1) = registrador(C.getIdOutputCirc(id));
+
+  reg.resize(Nin_circ+Nports+1, bool3S::UNDEF);
+}
+
+/// ***********************
+/// Funcoes de consulta
+/// ***********************
+
+/// Retorna a saida do circuito cuja id eh IdOutput na ultima simulacao.
+bool3S MaquinaVirtual::getOutputCirc(int IdOutput) const
+{
+  if (IdOutput<1 || IdOutput>getNumOutputs()) throw std::out_of_range("getOutputCirc: invalid ID");
+  return reg[reg_out[IdOutput-1]];
+}
+
+/// Retorna a saida da porta cuja id eh IdPort na ultima simulacao.
+bool3S MaquinaVirtual::getOutputPort(int IdPort) const
+{
+  if (IdPort<1 || IdPort>getNumPorts()) throw std::out_of_range("getOutputPort: invalid ID");
+  return reg[Nin_circ+IdPort-1];
+}
+
+/// Escreve o programa em O, uma instrucao por linha
+std::ostream& MaquinaVirtual::escrever(std::ostream& O) const
+{
+  static const char* nome[] = {"FIM", "COPIA", "NT", "AN", "NA", "OR", "NO", "XO", "NX"};
+  for (size_t k=0; k<prog.size(); ++k)
+  {
+    const Instrucao& I = prog[k];
+    O << k << ": " << nome[static_cast<int>(I.op)];
+    if (I.op != Opcode::FIM)
+    {
+      O << " r" << I.d << " r" << I.a;
+      if (I.op!=Opcode::COPIA && I.op!=Opcode::NT) O << " r" << I.b;
+    }
+    O << std::endl;
+  }
+  return O;
+}
+
+/// ***********************
+/// SIMULACAO
+/// ***********************
+
+/// Executa as instrucoes a partir de I ateh encontrar FIM
+void MaquinaVirtual::executar(const Instrucao* I)
+{
+  bool3S* R = reg.data();
+
+#if defined(__GNUC__)
+  // Despacho encadeado: cada instrucao salta diretamente para a proxima
+  // (a ordem dos rotulos eh a mesma de Opcode)
+  static const void* rotulo[] = {&&FIM, &&COPIA, &&NT, &&AN, &&NA, &&OR, &&NO, &&XO, &&NX};
+#define PROXIMA() goto *rotulo[static_cast<int>((++I)->op)]
+
+  goto *rotulo[static_cast<int>(I->op)];
+COPIA:
+  R[I->d] = R[I->a];
+  PROXIMA();
+NT:
+  R[I->d] = ~R[I->a];
+  PROXIMA();
+AN:
+  R[I->d] = R[I->a] & R[I->b];
+  PROXIMA();
+NA:
+  R[I->d] = ~(R[I->a] & R[I->b]);
+  PROXIMA();
+OR:
+  R[I->d] = R[I->a] | R[I->b];
+  PROXIMA();
+NO:
+  R[I->d] = ~(R[I->a] | R[I->b]);
+  PROXIMA();
+XO:
+  R[I->d] = R[I->a] ^ R[I->b];
+  PROXIMA();
+NX:
+  R[I->d] = ~(R[I->a] ^ R[I->b]);
+  PROXIMA();
+FIM:
+  return;
+#undef PROXIMA
+
+#else
+  // Despacho por switch
+  for (;; ++I)
+  {
+    switch (I->op)
+    {
+    case Opcode::COPIA: R[I->d] = R[I->a]; break;
+    case Opcode::NT: R[I->d] = ~R[I->a]; break;
+    case Opcode::AN: R[I->d] = R[I->a] & R[I->b]; break;
+    case Opcode::NA: R[I->d] = ~(R[I->a] & R[I->b]); break;
+    case Opcode::OR: R[I->d] = R[I->a] | R[I->b]; break;
+    case Opcode::NO: R[I->d] = ~(R[I->a] | R[I->b]); break;
+    case Opcode::XO: R[I->d] = R[I->a] ^ R[I->b]; break;
+    case Opcode::NX: R[I->d] = ~(R[I->a] ^ R[I->b]); break;
+    case Opcode::FIM:
+    default:
+      return;
+    }
+  }
+#endif
+}
+
+/// Calcula as saidas do circuito para os valores de entrada passados como parametro
+void MaquinaVirtual::simular(const std::vector<bool3S>& in_circ)
+{
+  if (static_cast<int>(in_circ.size()) != getNumInputs())
+    throw std::range_error("simular: incompatible parameter size");
+
+  for (int i=0; i<Nin_circ; ++i) reg[i] = in_circ[i];
+
+  // Portas fora de lacos: uma unica execucao
+  executar(prog.data());
+
+  // Portas em lacos: partindo de UNDEF, repete ateh nenhum registrador mudar
+  if (!reg_lacos.empty())
+  {
+    size_t k;
+    for (k=0; k<reg_lacos.size(); ++k) reg[reg_lacos[k]] = bool3S::UNDEF;
+    bool mudou;
+    do
+    {
+      for (k=0; k<reg_lacos.size(); ++k) ant_lacos[k] = reg[reg_lacos[k]];
+      executar(prog.data()+ini_lacos);
+      mudou = false;
+      for (k=0; k<reg_lacos.size(); ++k) mudou = mudou || (ant_lacos[k] != reg[reg_lacos[k]]);
+    } while (mudou);
+  }
+}
@@ -0,0 +1,110 @@
+#ifndef _MAQUINAVIRTUAL_H_
+#define _MAQUINAVIRTUAL_H_
+
+#include <iostream>
+#include <vector>
+#include "bool3S.h"
+#include "circuito.h"
+
+///
+/// CLASSE MAQUINAVIRTUAL
+///
+
+// Uma maquina virtual que simula um circuito traduzido para um codigo de instrucoes (bytecode).
+// Cada sinal do circuito eh um registrador: as entradas (entrada id=-(i+1) -> registrador i),
+// as portas (porta id -> registrador Nin_circ+id-1) e um registrador auxiliar (o ultimo).
+// Cada instrucao tem um codigo de operacao, um registrador de destino e dois operandos.
+// As portas com mais de 2 entradas sao traduzidas para uma sequencia de instrucoes que
+// acumula o resultado no registrador auxiliar; apenas a ultima escreve no registrador da porta.
+//
+// O programa tem duas partes, cada uma terminada pela instrucao FIM:
+// - as portas fora de lacos, em ordem de nivel, executadas uma unica vez;
+// - as portas em lacos (ou que dependem deles), que comecam indefinidas e sao executadas
+//   repetidamente ateh nenhum registrador mudar. Como as operacoes de bool3S sao monotonas,
+//   o resultado eh o mesmo de Circuito::simular.
+// O interpretador usa despacho encadeado (computed goto do GCC/Clang): ao final de cada
+// instrucao, salta diretamente para o codigo da proxima. Nos outros compiladores, usa um switch.
+//
+// A traducao eh linear no tamanho do circuito (alguns milissegundos para circuitos grandes),
+// de modo que a maquina pode ser reconstruida a cada modificacao do circuito.
+// Assim como o SimuladorBits, nao acompanha as modificacoes posteriores do Circuito.
+class MaquinaVirtual
+{
+public:
+  // Os codigos de operacao
+  enum class Opcode: unsigned char {FIM, COPIA, NT, AN, NA, OR, NO, XO, NX};
+
+  // Uma instrucao: R[d] = op(R[a], R[b]) (COPIA e NT usam apenas R[a])
+  struct Instrucao
+  {
+    Opcode op;
+    int d;
+    int a;
+    int b;
+  };
+
+private:
+  // NUMERO DE ENTRADAS, SAIDAS E PORTAS DO CIRCUITO
+  int Nin_circ;
+  int Nout_circ;
+  int Nports;
+
+  // O PROGRAMA: as portas fora de lacos em prog[0..ini_lacos-2] (prog[ini_lacos-1] eh FIM),
+  // as portas em lacos a partir de prog[ini_lacos] (terminadas por FIM)
+  std::vector<Instrucao> prog;
+  int ini_lacos;
+
+  // OS REGISTRADORES
+  std::vector<bool3S> reg;
+  // Os registradores das portas em lacos e seus valores antes da ultima execucao
+  std::vector<int> reg_lacos;
+  std::vector<bool3S> ant_lacos;
+
+  // O registrador de origem de cada saida do circuito
+  std::vector<int> reg_out;
+
+  // Executa as instrucoes a partir de I ateh encontrar FIM
+  void executar(const Instrucao* I);
+
+public:
+  // Nao existe maquina sem circuito
+  MaquinaVirtual() = delete;
+  // Traduz o circuito C para o codigo da maquina.
+  // Se o circuito for invalido, gera excecao.
+  explicit MaquinaVirtual(const Circuito& C);
+
+  int getNumInputs() const
+  {
+    return Nin_circ;
+  }
+  int getNumOutputs() const
+  {
+    return Nout_circ;
+  }
+  int getNumPorts() const
+  {
+    return Nports;
+  }
+  // O numero de instrucoes do programa (incluindo as duas instrucoes FIM)
+  int getNumInstrucoes() const
+  {
+    return int(prog.size());
+  }
+
+  // Retorna a saida do circuito cuja id eh IdOutput na ultima simulacao.
+  // Gera excecao se o parametro for invalido.
+  bool3S getOutputCirc(int IdOutput) const;
+  // Retorna a saida da porta cuja id eh IdPort na ultima simulacao.
+  // Gera excecao se o parametro for invalido.
+  bool3S getOutputPort(int IdPort) const;
+
+  // Calcula as saidas do circuito para os valores de entrada passados como parametro
+  // (a mesma interface de Circuito::simular).
+  // Se o parametro for invalido, gera excecao.
+  void simular(const std::vector<bool3S>& in_circ);
+
+  // Escreve o programa em O, uma instrucao por linha (para depuracao)
+  std::ostream& escrever(std::ostream& O) const;
+};
+
+#endif // _MAQUINAVIRTUAL_H_
@@ -0,0 +1,285 @@
+#include <stdexcept>
+#include <algorithm>
+#include <vector>
+#include "otimizador.h"
+
+///
+/// OTIMIZACAO DE CIRCUITOS
+///
+
+namespace {
+
+// O valor de uma porta do tipo T com as entradas de valores in
+bool3S avaliar(TipoPorta T, const std::vector<bool3S>& in)
+{
+  bool3S res = in.at(0);
+  for (size_t j=1; j<in.size(); ++j)
+  {
+    if (T==TipoPorta::AN || T==TipoPorta::NA) res = res & in[j];
+    else if (T==TipoPorta::OR || T==TipoPorta::NO) res = res | in[j];
+    else res = res ^ in[j];
+  }
+  if (T==TipoPorta::NT || T==TipoPorta::NA || T==TipoPorta::NO || T==TipoPorta::NX) res = ~res;
+  return res;
+}
+
+// O circuito em otimizacao: as portas cuja id=1..NP, com os sinais indexados por IdOrig
+class Otimizacao
+{
+public:
+  int NI;
+  int NP;
+  // O tipo e as origens das entradas de cada porta (posicao 0 nao usada)
+  std::vector<TipoPorta> tipo;
+  std::vector< std::vector<int> > in;
+  // O sinal que substitui cada porta (a propria porta, se ela nao foi substituida)
+  std::vector<int> subst;
+  // O valor constante de cada sinal (indexado por NI+IdOrig), ou -1 se nao for constante
+  std::vector<int> constante;
+  // Um sinal com cada valor constante (indexado por int(bool3S)), ou 0 se nao houver
+  int sinal_const[3];
+  RelatorioOtimizacao R;
+
+  Otimizacao(const Circuito& C, const std::map<int,bool3S>& constantes);
+
+  // O sinal que substitui a origem IdOrig
+  int renomear(int IdOrig) const
+  {
+    return (IdOrig>0 ? subst[IdOrig] : IdOrig);
+  }
+  // true se o sinal eh uma porta NOT que nao foi substituida
+  bool ehInversor(int IdOrig) const
+  {
+    return IdOrig>0 && subst[IdOrig]==IdOrig && tipo[IdOrig]==TipoPorta::NT;
+  }
+
+  // Simplifica a porta id, fora de lacos, cujas origens jah foram todas simplificadas
+  void simplificar(int id);
+  // A porta id tem o valor constante k: substitui por um sinal com esse valor, se houver
+  void tornarConstante(int id, bool3S k);
+  // Gera o circuito otimizado, sem as portas substituidas e sem as que nao alcancam as saidas
+  Circuito gerar(const Circuito& C);
+};
+
+Otimizacao::Otimizacao(const Circuito& C, const std::map<int,bool3S>& constantes)
+    : NI(C.getNumInputs()),
+      NP(C.getNumPorts()),
+      tipo(NP+1, TipoPorta::NT),
+      in(NP+1),
+      subst(NP+1),
+      constante(NI+NP+1, -1),
+      sinal_const(),
+      R()
+{
+  R.Nportas_antes = NP;
+  for (int k=0; k<3; ++k) sinal_const[k] = 0;
+  for (const auto& E : constantes)
+  {
+    if (E.first>-1 || E.first<-NI) throw std::out_of_range("otimizarCircuito: invalid input ID");
+    constante[NI+E.first] = static_cast<int>(E.second);
+    sinal_const[static_cast<int>(E.second)] = E.first;
+  }
+  for (int id=1; id<=NP; ++id)
+  {
+    tipo[id] = toTipoPorta(C.getNamePort(id));
+    for (int j=0; j<C.getNumInputsPort(id); ++j) in[id].push_back(C.getIdInPort(id,j));
+    subst[id] = id;
+  }
+}
+
+void Otimizacao::tornarConstante(int id, bool3S k)
+{
+  int K = static_cast<int>(k);
+  constante[NI+id] = K;
+  if (sinal_const[K] != 0)
+  {
+    subst[id] = sinal_const[K];
+    ++R.Nconstantes;
+    return;
+  }
+  // Com um sinal de valor ~k (definido), a porta vira uma NOT desse sinal
+  int inv = sinal_const[static_cast<int>(~k)];
+  if (k!=bool3S::UNDEF && inv!=0)
+  {
+    tipo[id] = TipoPorta::NT;
+    in[id].assign(1, inv);
+  }
+  sinal_const[K] = id;
+}
+
+void Otimizacao::simplificar(int id)
+{
+  std::vector<int>& E = in[id];
+  for (int& x : E) x = renomear(x);
+  TipoPorta T = tipo[id];
+
+  if (T != TipoPorta::NT)
+  {
+    // A operacao basica (AND, OR ou XOR) e se a porta eh inversora
+    TipoPorta base = (T==TipoPorta::AN || T==TipoPorta::NA ? TipoPorta::AN :
+                      T==TipoPorta::OR || T==TipoPorta::NO ? TipoPorta::OR : TipoPorta::XO);
+    bool inv = (T==TipoPorta::NA || T==TipoPorta::NO || T==TipoPorta::NX);
+
+    std::vector<int> L;
+    for (int x : E)
+    {
+      int c = constante[NI+x];
+      if (c == static_cast<int>(bool3S::TRUE))
+      {
+        if (base == TipoPorta::OR) { tornarConstante(id, inv ? bool3S::FALSE : bool3S::TRUE); return; }
+        if (base == TipoPorta::XO) inv = !inv;
+        continue;
+      }
+      if (c == static_cast<int>(bool3S::FALSE))
+      {
+        if (base == TipoPorta::AN) { tornarConstante(id, inv ? bool3S::TRUE : bool3S::FALSE); return; }
+        continue;
+      }
+      if (base!=TipoPorta::XO && std::find(L.begin(), L.end(), x)!=L.end())
+      {
+        ++R.Nrepetidas;
+        continue;
+      }
+      L.push_back(x);
+    }
+
+    if (L.empty())
+    {
+      // Todas as entradas foram removidas: AND() = TRUE, OR() = XOR() = FALSE
+      bool3S k = (base==TipoPorta::AN ? bool3S::TRUE : bool3S::FALSE);
+      tornarConstante(id, inv ? ~k : k);
+      return;
+    }
+    if (L.size() == 1)
+    {
+      if (!inv)
+      {
+        subst[id] = L[0];
+        ++R.Nligacoes;
+        return;
+      }
+      T = TipoPorta::NT;
+    }
+    else
+    {
+      T = (base==TipoPorta::AN ? (inv ? TipoPorta::NA : TipoPorta::AN) :
+           base==TipoPorta::OR ? (inv ? TipoPorta::NO : TipoPorta::OR) :
+                                 (inv ? TipoPorta::NX : TipoPorta::XO));
+    }
+    tipo[id] = T;
+    E = L;
+  }
+
+  // Dupla inversao
+  if (T==TipoPorta::NT && ehInversor(E[0]))
+  {
+    subst[id] = in[E[0]][0];
+    ++R.Ninversoes;
+    return;
+  }
+
+  // Porta com todas as entradas constantes
+  std::vector<bool3S> valores;
+  for (int x : E)
+  {
+    if (constante[NI+x] < 0) return;
+    valores.push_back(static_cast<bool3S>(constante[NI+x]));
+  }
+  tornarConstante(id, avaliar(T, valores));
+}
+
+Circuito Otimizacao::gerar(const Circuito& C)
+{
+  int NO = C.getNumOutputs();
+  std::vector<int> saida(NO);
+  for (int j=0; j<NO; ++j) saida[j] = renomear(C.getIdOutputCirc(j+1));
+
+  // As portas que alcancam alguma saida (busca a partir das saidas)
+  std::vector<char> viva(NP+1, 0);
+  std::vector<int> pilha;
+  for (int x : saida)
+  {
+    if (x>0 && !viva[x]) { viva[x] = 1; pilha.push_back(x); }
+  }
+  while (!pilha.empty())
+  {
+    int id = pilha.back();
+    pilha.pop_back();
+    for (int x : in[id])
+    {
+      if (x>0 && !viva[x]) { viva[x] = 1; pilha.push_back(x); }
+    }
+  }
+
+  // Novas ids, na mesma ordem das antigas
+  std::vector<int> nova_id(NP+1, 0);
+  int Nnovas = 0;
+  for (int id=1; id<=NP; ++id)
+  {
+    if (subst[id]!=id) continue;
+    if (viva[id]) nova_id[id] = ++Nnovas;
+    else ++R.Nmortas;
+  }
+  auto nova = [&nova_id](int IdOrig) { return (IdOrig>0 ? nova_id[IdOrig] : IdOrig); };
+
+  // Um circuito deve ter pelo menos uma porta: se nenhuma for necessaria, mantem uma NOT
+  Circuito O(NI, NO, std::max(Nnovas, 1));
+  if (Nnovas == 0)
+  {
+    O.setPort(1, "NT", 1);
+    O.setIdInPort(1, 0, -1);
+  }
+  for (int id=1; id<=NP; ++id)
+  {
+    if (nova_id[id] == 0) continue;
+    O.setPort(nova_id[id], toSigla(tipo[id]), int(in[id].size()));
+    for (size_t j=0; j<in[id].size(); ++j) O.setIdInPort(nova_id[id], int(j), nova(in[id][j]));
+  }
+  for (int j=0; j<NO; ++j) O.setIdOutputCirc(j+1, nova(saida[j]));
+
+  R.Nportas_depois = O.getNumPorts();
+  return O;
+}
+
+} // namespace
+
+/// Retorna o circuito C otimizado, sem entradas constantes.
+Circuito otimizarCircuito(const Circuito& C, RelatorioOtimizacao* R)
+{
+  return otimizarCircuito(C, std::map<int,bool3S>(), R);
+}
+
+/// Retorna o circuito C otimizado, considerando as entradas constantes.
+Circuito otimizarCircuito(const Circuito& C, const std::map<int,bool3S>& constantes,
+                          RelatorioOtimizacao* R)
+{
+  if (!C.valid()) throw std::logic_error("otimizarCircuito: invalid circuit");
+
+  Otimizacao Opt(C, constantes);
+
+  // As portas fora de lacos sao simplificadas em ordem de nivel,
+  // de modo que as origens de cada porta jah foram simplificadas
+  int Nniveis = C.getProfundidade();
+  std::vector< std::vector<int> > por_nivel(Nniveis+1);
+  for (int id=1; id<=Opt.NP; ++id)
+  {
+    int n = C.getNivelPort(id);
+    if (n >= 0) por_nivel.at(n).push_back(id);
+  }
+  for (const auto& nivel : por_nivel)
+  {
+    for (int id : nivel) Opt.simplificar(id);
+  }
+  // As portas em lacos (ou que dependem deles) apenas tem suas entradas renomeadas
+  for (int id=1; id<=Opt.NP; ++id)
+  {
+    if (C.getNivelPort(id) < 0)
+    {
+      for (int& x : Opt.in[id]) x = Opt.renomear(x);
+    }
+  }
+
+  Circuito O = Opt.gerar(C);
+  if (R != nullptr) *R = Opt.R;
+  return O;
+}
@@ -0,0 +1,64 @@
+#ifndef _OTIMIZADOR_H_
+#define _OTIMIZADOR_H_
+
+#include <map>
+#include "bool3S.h"
+#include "circuito.h"
+
+///
+/// OTIMIZACAO DE CIRCUITOS
+///
+
+// Gera um circuito menor, com as mesmas entradas e saidas e o mesmo comportamento
+// (as mesmas saidas para qualquer vetor de entrada, inclusive as saidas bool3S::UNDEF).
+// As transformacoes aplicadas sao:
+// - propagacao de constantes: as entradas do circuito indicadas em "constantes" sao
+//   consideradas fixas (o circuito otimizado soh eh equivalente quando elas tem esses valores).
+//   Uma entrada constante que nao altera o resultado da porta eh removida (TRUE em AND,
+//   FALSE em OR e XOR); um valor controlador (FALSE em AND, TRUE em OR) torna a porta constante;
+//   TRUE em XOR inverte a porta. Como nao existem portas constantes, uma porta constante soh
+//   eh substituida se houver um sinal com o mesmo valor (uma entrada fixa ou seu inverso);
+// - entradas repetidas: AND(a,a,b) = AND(a,b), idem para OR, NAND e NOR
+//   (em XOR as entradas repetidas sao mantidas: a^a nao eh constante se a for UNDEF);
+// - portas com uma unica entrada restante viram uma ligacao direta ou uma NOT;
+// - dupla inversao: NOT(NOT(a)) = a;
+// - remocao das portas cuja saida nao alcanca nenhuma saida do circuito.
+// As portas em lacos (ou que dependem deles) soh tem suas entradas renomeadas.
+
+// Estatisticas de uma otimizacao
+struct RelatorioOtimizacao
+{
+  // O numero de portas antes e depois da otimizacao
+  int Nportas_antes;
+  int Nportas_depois;
+  // Portas removidas por nao alcancarem nenhuma saida do circuito
+  int Nmortas;
+  // Portas substituidas por uma constante
+  int Nconstantes;
+  // Portas substituidas por uma ligacao direta (uma unica entrada restante ou dupla inversao)
+  int Nligacoes;
+  // Duplas inversoes eliminadas
+  int Ninversoes;
+  // Entradas repetidas eliminadas
+  int Nrepetidas;
+
+  // O numero de portas removidas
+  int removidas() const
+  {
+    return Nportas_antes-Nportas_depois;
+  }
+};
+
+// Retorna o circuito C otimizado, sem entradas constantes.
+// Se R != nullptr, preenche as estatisticas da otimizacao.
+// Se o circuito for invalido, gera excecao.
+Circuito otimizarCircuito(const Circuito& C, RelatorioOtimizacao* R=nullptr);
+
+// Retorna o circuito C otimizado, considerando que cada entrada IdInput em "constantes"
+// tem sempre o valor constantes[IdInput].
+// Se R != nullptr, preenche as estatisticas da otimizacao.
+// Se o circuito ou alguma entrada constante forem invalidos, gera excecao.
+Circuito otimizarCircuito(const Circuito& C, const std::map<int,bool3S>& constantes,
+                          RelatorioOtimizacao* R=nullptr);
+
+#endif // _OTIMIZADOR_H_
@@ -1,14 +1,54 @@
+#include <stdexcept>
 #include "porta.h"
 
+///
+/// OS TIPOS DE PORTA
+///
+
+TipoPorta toTipoPorta(const std::string& Sigla)
+{
+    if (Sigla == "NT") return TipoPorta::NT;
+    if (Sigla == "AN") return TipoPorta::AN;
+    if (Sigla == "NA") return TipoPorta::NA;
+    if (Sigla == "OR") return TipoPorta::OR;
+    if (Sigla == "NO") return TipoPorta::NO;
+    if (Sigla == "XO") return TipoPorta::XO;
+    if (Sigla == "NX") return TipoPorta::NX;
+    throw std::invalid_argument("toTipoPorta: sigla de porta invalida.");
+}
+
+std::string toSigla(TipoPorta T)
+{
+    static const char* siglas[NUM_TIPOS_PORTA] = {"NT", "AN", "NA", "OR", "NO", "XO", "NX"};
+    return siglas[static_cast<int>(T)];
+}
+
+ptr_Porta novaPorta(TipoPorta T, int Nin)
+{
+    switch (T)
+    {
+    case TipoPorta::NT:
+        if (Nin != 1) throw std::invalid_argument("novaPorta: PortaNOT precisa de exatamente uma entrada.");
+        return new PortaNOT();
+    case TipoPorta::AN: return new PortaAND(Nin);
+    case TipoPorta::NA: return new PortaNAND(Nin);
+    case TipoPorta::OR: return new PortaOR(Nin);
+    case TipoPorta::NO: return new PortaNOR(Nin);
+    case TipoPorta::XO: return new PortaXOR(Nin);
+    case TipoPorta::NX: return new PortaNXOR(Nin);
+    }
+    throw std::invalid_argument("novaPorta: tipo de porta invalido.");
+}
+
 ///
 /// AS PORTAS
 ///
 
 /// Porta NOT
 
-void PortaNOT::simular(const std::vector<bool3S>& in_port)
+void PortaNOT::simular(const bool3S* in_port, int Nin)
 {
-    if (in_port.size() != 1) throw std::invalid_argument("PortaNOT: precisa de exatamente uma entrada.");
+    if (Nin != 1) throw std::invalid_argument("PortaNOT: precisa de exatamente uma entrada.");
 
     out_port = ~in_port[0];
 
@@ -22,13 +62,14 @@ PortaAND::PortaAND(int NI) : Porta(NI)
     if (NI < 2) throw std::invalid_argument("PortaAND deve ter pelo menos 2 entradas.");
 }
 
-void PortaAND::simular(const std::vector<bool3S>& in_port)
+void PortaAND::simular(const bool3S* in_port, int Nin)
 {
-    if (in_port.size() >0 && in_port.size()== static_cast<size_t>(Nin_port))
+    if (Nin > 0 && Nin == Nin_port)
     {
         bool3S res = in_port[0];
 
-        for (size_t i = 1; i < in_port.size(); ++i)
+        // Uma entrada FALSE decide o resultado: as demais nao precisam ser lidas
+        for (int i = 1; i < Nin && res != bool3S::FALSE; ++i)
         {
 
             res = res & in_port[i];
@@ -50,13 +91,14 @@ PortaNAND::PortaNAND(int NI) : Porta(NI)
     if (NI < 2) throw std::invalid_argument("PortaNAND deve ter pelo menos 2 entradas.");
 }
 
-void PortaNAND::simular(const std::vector<bool3S>& in_port)
+void PortaNAND::simular(const bool3S* in_port, int Nin)
 {
-    if (in_port.size() >0 && in_port.size()==static_cast<size_t>(Nin_port))
+    if (Nin > 0 && Nin == Nin_port)
     {
         bool3S res = in_port[0];
 
-        for (size_t i = 1; i < in_port.size(); ++i)
+        // Uma entrada FALSE decide o resultado: as demais nao precisam ser lidas
+        for (int i = 1; i < Nin && res != bool3S::FALSE; ++i)
         {
 
             res = res & in_port[i];
@@ -77,13 +119,14 @@ PortaOR::PortaOR(int NI) : Porta(NI)
     if (NI < 2) throw std::invalid_argument("PortaOR deve ter pelo menos 2 entradas.");
 }
 
-void PortaOR::simular(const std::vector<bool3S>& in_port)
+void PortaOR::simular(const bool3S* in_port, int Nin)
 {
-    if (in_port.size() >0 && in_port.size()==static_cast<size_t>(Nin_port))
+    if (Nin > 0 && Nin == Nin_port)
     {
         bool3S res = in_port[0];
 
-        for (size_t i = 1; i < in_port.size(); ++i)
+        // Uma entrada TRUE decide o resultado: as demais nao precisam ser lidas
+        for (int i = 1; i < Nin && res != bool3S::TRUE; ++i)
         {
 
             res = res | in_port[i];
@@ -104,13 +147,14 @@ PortaNOR::PortaNOR(int NI) : Porta(NI)
     if (NI < 2) throw std::invalid_argument("PortaNOR deve ter pelo menos 2 entradas.");
 }
 
-void PortaNOR::simular(const std::vector<bool3S>& in_port)
+void PortaNOR::simular(const bool3S* in_port, int Nin)
 {
-    if (in_port.size() >0 && in_port.size()==static_cast<size_t>(Nin_port))
+    if (Nin > 0 && Nin == Nin_port)
     {
         bool3S res = in_port[0];
 
-        for (size_t i = 1; i < in_port.size(); ++i)
+        // Uma entrada TRUE decide o resultado: as demais nao precisam ser lidas
+        for (int i = 1; i < Nin && res != bool3S::TRUE; ++i)
         {
 
             res = res | in_port[i];
@@ -131,13 +175,14 @@ PortaXOR::PortaXOR(int NI) : Porta(NI)
     if (NI < 2) throw std::invalid_argument("PortaXOR deve ter pelo menos 2 entradas.");
 }
 
-void PortaXOR::simular(const std::vector<bool3S>& in_port)
+void PortaXOR::simular(const bool3S* in_port, int Nin)
 {
-    if (in_port.size() >0 && in_port.size()==static_cast<size_t>(Nin_port))
+    if (Nin > 0 && Nin == Nin_port)
     {
         bool3S res = in_port[0];
 
-        for (size_t i = 1; i < in_port.size(); ++i)
+        // Uma entrada UNDEF decide o resultado: as demais nao precisam ser lidas
+        for (int i = 1; i < Nin && res != bool3S::UNDEF; ++i)
         {
 
             res = res ^ in_port[i];
@@ -158,13 +203,14 @@ PortaNXOR::PortaNXOR(int NI) : Porta(NI)
     if (NI < 2) throw std::invalid_argument("PortaNXOR deve ter pelo menos 2 entradas.");
 }
 
-void PortaNXOR::simular(const std::vector<bool3S>& in_port)
+void PortaNXOR::simular(const bool3S* in_port, int Nin)
 {
-    if (in_port.size() >0 && in_port.size()==static_cast<size_t>(Nin_port))
+    if (Nin > 0 && Nin == Nin_port)
     {
         bool3S res = in_port[0];
 
-        for (size_t i = 1; i < in_port.size(); ++i)
+        // Uma entrada UNDEF decide o resultado: as demais nao precisam ser lidas
+        for (int i = 1; i < Nin && res != bool3S::UNDEF; ++i)
         {
 
             res = res ^ in_port[i];
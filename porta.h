@@ -5,6 +5,26 @@
 #include <vector>
 #include "bool3S.h"
 
+///
+/// OS TIPOS DE PORTA
+///
+
+// Os tipos de porta, na mesma ordem em que sao usualmente listadas as siglas
+enum class TipoPorta: unsigned char
+{
+  NT, AN, NA, OR, NO, XO, NX
+};
+
+// O numero de tipos de porta
+const int NUM_TIPOS_PORTA = 7;
+
+// Converte uma sigla (NT, AN, NA, OR, NO, XO, NX) para o TipoPorta correspondente.
+// Se a sigla for invalida, gera excecao.
+TipoPorta toTipoPorta(const std::string& Sigla);
+
+// Converte um TipoPorta para a sigla correspondente (NT, AN, NA, OR, NO, XO, NX)
+std::string toSigla(TipoPorta T);
+
 ///
 /// A CLASSE ABSTRATA PORTA
 ///
@@ -43,6 +63,10 @@ public:
   // Funcao virtual pura que retorna a sigla correta da Port (AN, NT, OR, NX, etc.)
   virtual std::string getName() const = 0;
 
+  // Funcao virtual pura que retorna o tipo da porta (TipoPorta::AN, TipoPorta::NT, etc.)
+  // O tipo eh o "opcode" usado pelas rotinas de simulacao que nao usam as funcoes virtuais
+  virtual TipoPorta getTipo() const = 0;
+
   // Retorna o numero de entradas da porta
   int getNumInputs() const
   {
@@ -70,12 +94,20 @@ public:
   /// ***********************
 
   // Simula uma porta logica.
-  // Recebe um vector de bool3S com os valores logicos das entradas da porta
-  // com os quais deve ser simulada a funcao logica da porta.
-  // Se a dimensao do vetor in_port for adequada (>0 e igual ao numero de entradas
-  // da porta), armazena o resultado da simulacao em out_port e retorna true.
+  // Recebe um ponteiro para os Nin valores logicos (consecutivos) das entradas da porta
+  // com os quais deve ser simulada a funcao logica da porta. Os valores podem estar
+  // em qualquer area de memoria reaproveitavel: a porta nao aloca nem guarda nada.
+  // Se Nin for adequado (>0 e igual ao numero de entradas da porta),
+  // armazena o resultado da simulacao em out_port.
   // Se nao for, gera excecao.
-  virtual void simular(const std::vector<bool3S>& in_port) = 0;
+  virtual void simular(const bool3S* in_port, int Nin) = 0;
+
+  // Simula uma porta logica a partir de um vector de bool3S com os valores das entradas.
+  // Equivale a simular(in_port.data(), in_port.size()).
+  void simular(const std::vector<bool3S>& in_port)
+  {
+    simular(in_port.data(), int(in_port.size()));
+  }
 };
 
 ///
@@ -98,7 +130,12 @@ public:
   {
       return "NT";
   }
-  void simular(const std::vector<bool3S>& in_port) override;
+  TipoPorta getTipo() const override
+  {
+      return TipoPorta::NT;
+  }
+  using Porta::simular;
+  void simular(const bool3S* in_port, int Nin) override;
 
 };
 
@@ -121,7 +158,12 @@ public:
   {
       return "AN";
   }
-  void simular(const std::vector<bool3S>& in_port) override;
+  TipoPorta getTipo() const override
+  {
+      return TipoPorta::AN;
+  }
+  using Porta::simular;
+  void simular(const bool3S* in_port, int Nin) override;
   //
 };
 
@@ -144,7 +186,12 @@ public:
   {
       return "NA";
   }
-  void simular(const std::vector<bool3S>& in_port) override;
+  TipoPorta getTipo() const override
+  {
+      return TipoPorta::NA;
+  }
+  using Porta::simular;
+  void simular(const bool3S* in_port, int Nin) override;
   //
 };
 
@@ -167,7 +214,12 @@ public:
   {
       return "OR";
   }
-  void simular(const std::vector<bool3S>& in_port) override;
+  TipoPorta getTipo() const override
+  {
+      return TipoPorta::OR;
+  }
+  using Porta::simular;
+  void simular(const bool3S* in_port, int Nin) override;
   //
 };
 
@@ -190,7 +242,12 @@ public:
   {
       return "NO";
   }
-  void simular(const std::vector<bool3S>& in_port) override;
+  TipoPorta getTipo() const override
+  {
+      return TipoPorta::NO;
+  }
+  using Porta::simular;
+  void simular(const bool3S* in_port, int Nin) override;
   //
 };
 
@@ -213,7 +270,12 @@ public:
   {
       return "XO";
   }
-  void simular(const std::vector<bool3S>& in_port) override;
+  TipoPorta getTipo() const override
+  {
+      return TipoPorta::XO;
+  }
+  using Porta::simular;
+  void simular(const bool3S* in_port, int Nin) override;
   //
 };
 
@@ -236,8 +298,21 @@ public:
   {
       return "NX";
   }
-  void simular(const std::vector<bool3S>& in_port) override;
+  TipoPorta getTipo() const override
+  {
+      return TipoPorta::NX;
+  }
+  using Porta::simular;
+  void simular(const bool3S* in_port, int Nin) override;
   //
 };
 
+///
+/// CRIACAO DE PORTAS A PARTIR DO TIPO
+///
+
+// Cria (alocando dinamicamente) uma porta do tipo T com Nin entradas.
+// Se o numero de entradas for invalido para o tipo, gera excecao.
+ptr_Porta novaPorta(TipoPorta T, int Nin);
+
 #endif // _PORTA_H_
@@ -0,0 +1,136 @@
+#include <stdexcept>
+#include "simuladorbits.h"
+
+///
+/// CLASSE SIMULADORBITS
+///
+
+/// ***********************
+/// Inicializacao
+/// ***********************
+
+/// Constroi o simulador para o circuito C, usando o kernel K para avaliar as portas.
+/// Se o circuito for invalido, gera excecao.
+SimuladorBits::SimuladorBits(const Circuito& C, const KernelPortas& K)
+    : kernel(&K),
+      Npal(K.Npalavras),
+      Nin_circ(C.getNumInputs()),
+      Nout_circ(C.getNumOutputs()),
+      Nports(C.getNumPorts()),
+      tipo(),
+      sinal_port(),
+      ini_in(),
+      sinal_in(),
+      Nacicl(0),
+      sinal_out(),
+      sinais()
+{
+  if (!C.valid()) throw std::logic_error("SimuladorBits: invalid circuit");
+
+  int id, j, k;
+
+  // Ordena as portas por nivel (ordenacao por contagem), deixando ao final
+  // as portas em lacos (nivel -1), em ordem crescente de id
+  int Nniveis = C.getProfundidade();
+  std::vector<int> ini_nivel(Nniveis+2, 0);
+  for (id=1; id<=Nports; ++id)
+  {
+    int n = C.getNivelPort(id);
+    ++ini_nivel.at(n<0 ? Nniveis+1 : n);
+  }
+  for (k=1; k<=Nniveis+1; ++k) ini_nivel.at(k) += ini_nivel.at(k-1);
+  Nacicl = ini_nivel.at(Nniveis);
+  std::vector<int> ordem(Nports);
+  for (id=Nports; id>=1; --id)
+  {
+    int n = C.getNivelPort(id);
+    ordem.at(--ini_nivel.at(n<0 ? Nniveis+1 : n)) = id;
+  }
+
+  // Copia o tipo e a conectividade das portas, na ordem de avaliacao
+  tipo.resize(Nports);
+  sinal_port.resize(Nports);
+  ini_in.resize(Nports+1);
+  ini_in.at(0) = 0;
+  for (k=0; k<Nports; ++k)
+  {
+    id = ordem.at(k);
+    tipo.at(k) = toTipoPorta(C.getNamePort(id));
+    sinal_port.at(k) = Nin_circ+id-1;
+    for (j=0; j<C.getNumInputsPort(id); ++j)
+    {
+      int id_orig = C.getIdInPort(id,j);
+      sinal_in.push_back(id_orig>0 ? Nin_circ+id_orig-1 : -id_orig-1);
+    }
+    ini_in.at(k+1) = int(sinal_in.size());
+  }
+
+  // As origens das saidas
+  sinal_out.resize(Nout_circ);
+  for (id=1; id<=Nout_circ; ++id)
+  {
+    int id_orig = C.getIdOutputCirc(id);
+    sinal_out.at(id-1) = (id_orig>0 ? Nin_circ+id_orig-1 : -id_orig-1);
+  }
+
+  sinais.resize(2*Npal*(Nin_circ+Nports));
+}
+
+/// ***********************
+/// Funcoes de consulta
+/// ***********************
+
+/// Retorna a w-esima palavra da saida do circuito cuja id eh IdOutput.
+bool3S64 SimuladorBits::getOutputCirc(int IdOutput, int w) const
+{
+  if (IdOutput<1 || IdOutput>getNumOutputs()) throw std::out_of_range("getOutputCirc: invalid ID");
+  if (w<0 || w>=Npal) throw std::out_of_range("getOutputCirc: invalid word");
+  return getSinal(sinal_out[IdOutput-1], w);
+}
+
+/// Retorna a w-esima palavra da saida da porta cuja id eh IdPort.
+bool3S64 SimuladorBits::getOutputPort(int IdPort, int w) const
+{
+  if (IdPort<1 || IdPort>getNumPorts()) throw std::out_of_range("getOutputPort: invalid ID");
+  if (w<0 || w>=Npal) throw std::out_of_range("getOutputPort: invalid word");
+  return getSinal(Nin_circ+IdPort-1, w);
+}
+
+/// ***********************
+/// SIMULACAO
+/// ***********************
+
+/// Calcula as saidas do circuito para um bloco de vetores de entrada.
+void SimuladorBits::simular(const std::vector<bool3S64>& in_circ)
+{
+  if (static_cast<int>(in_circ.size()) != getNumInputs()*Npal)
+    throw std::range_error("simular: incompatible parameter size");
+
+  int i, w, k;
+
+  for (i=0; i<Nin_circ; ++i)
+  {
+    for (w=0; w<Npal; ++w)
+    {
+      sinais[2*Npal*i+w] = in_circ[i*Npal+w].f;
+      sinais[2*Npal*i+Npal+w] = in_circ[i*Npal+w].t;
+    }
+  }
+
+  // Portas fora de lacos: uma unica avaliacao de cada, em ordem de nivel
+  kernel->avaliar(tipo.data(), sinal_port.data(), ini_in.data(), sinal_in.data(),
+                  0, Nacicl, sinais.data(), false);
+
+  // Portas em lacos: partindo de UNDEF, repete ateh nenhum valor mudar.
+  // Como as operacoes de bool3S sao monotonas (um valor definido nunca volta a ser UNDEF),
+  // o resultado em cada padrao eh o mesmo da iteracao de Circuito::simular.
+  if (Nacicl < Nports)
+  {
+    for (k=Nacicl; k<Nports; ++k)
+    {
+      for (w=0; w<2*Npal; ++w) sinais[2*Npal*sinal_port[k]+w] = ~uint64_t(0);
+    }
+    while (kernel->avaliar(tipo.data(), sinal_port.data(), ini_in.data(), sinal_in.data(),
+                           Nacicl, Nports, sinais.data(), true));
+  }
+}
@@ -0,0 +1,129 @@
+#ifndef _SIMULADORBITS_H_
+#define _SIMULADORBITS_H_
+
+#include <vector>
+#include "bool3S64.h"
+#include "circuito.h"
+#include "kernelsportas.h"
+
+///
+/// CLASSE SIMULADORBITS
+///
+
+// Simulador que calcula as saidas de um circuito para um bloco de vetores de entrada de uma soh vez.
+// Cada sinal (entrada do circuito, saida de porta ou saida do circuito) eh representado
+// por Npalavras bool3S64, ou seja, 64*Npalavras valores: o k-esimo valor da w-esima palavra
+// corresponde ao vetor de entrada de indice 64*w+k dentro do bloco.
+// O tamanho do bloco eh definido pelo kernel usado para avaliar as portas (ver kernelsportas.h):
+// 64 padroes no kernel escalar, 256 no AVX2 e 512 no AVX-512.
+// O simulador eh construido a partir de um Circuito valido e nao acompanha as
+// modificacoes posteriores desse Circuito: se o circuito mudar, deve ser construido de novo.
+// Os resultados sao exatamente os mesmos que seriam obtidos com uma chamada a Circuito::simular
+// para cada vetor de entrada, inclusive as saidas bool3S::UNDEF.
+class SimuladorBits
+{
+private:
+  // O KERNEL QUE AVALIA AS PORTAS E O NUMERO DE PALAVRAS POR TRILHO EM CADA SINAL
+  const KernelPortas* kernel;
+  int Npal;
+
+  // NUMERO DE ENTRADAS, SAIDAS E PORTAS DO CIRCUITO
+  int Nin_circ;
+  int Nout_circ;
+  int Nports;
+
+  // AS PORTAS, NA ORDEM DE AVALIACAO
+  // Primeiro as portas fora de lacos, em ordem crescente de nivel;
+  // depois as Nports-Nacicl portas em lacos ou que dependem deles.
+  // Os sinais sao indexados de 0 a Nin_circ+Nports-1: primeiro as entradas do circuito
+  // (entrada id=-(i+1) -> sinal i), depois as portas (porta id -> sinal Nin_circ+id-1).
+
+  // O tipo da k-esima porta na ordem de avaliacao
+  std::vector<TipoPorta> tipo;
+  // O sinal de saida da k-esima porta na ordem de avaliacao
+  std::vector<int> sinal_port;
+  // Os sinais das entradas da k-esima porta estao em sinal_in[ini_in[k]..ini_in[k+1]-1]
+  std::vector<int> ini_in;
+  std::vector<int> sinal_in;
+  // O numero de portas fora de lacos (no inicio da ordem de avaliacao)
+  int Nacicl;
+
+  // O sinal de origem de cada saida do circuito
+  std::vector<int> sinal_out;
+
+  // OS VALORES LOGICOS
+  // Os valores de todos os sinais, no formato dos kernels:
+  // o sinal s ocupa as palavras sinais[2*Npal*s .. 2*Npal*(s+1)-1] (primeiro o trilho f, depois t)
+  std::vector<uint64_t> sinais;
+
+  // Retorna a w-esima palavra do sinal s
+  bool3S64 getSinal(int s, int w) const
+  {
+    return bool3S64(sinais[2*Npal*s+w], sinais[2*Npal*s+Npal+w]);
+  }
+
+public:
+  /// ***********************
+  /// Inicializacao
+  /// ***********************
+
+  // Nao existe simulador sem circuito
+  SimuladorBits() = delete;
+  // Constroi o simulador para o circuito C, usando o kernel K para avaliar as portas.
+  // Por default, usa o kernel mais largo disponivel no processador em uso.
+  // Se o circuito for invalido, gera excecao.
+  explicit SimuladorBits(const Circuito& C, const KernelPortas& K = kernelPortas());
+
+  /// ***********************
+  /// Funcoes de consulta
+  /// ***********************
+
+  int getNumInputs() const
+  {
+    return Nin_circ;
+  }
+  int getNumOutputs() const
+  {
+    return Nout_circ;
+  }
+  int getNumPorts() const
+  {
+    return Nports;
+  }
+
+  // O kernel usado para avaliar as portas
+  const KernelPortas& getKernel() const
+  {
+    return *kernel;
+  }
+  // O numero de bool3S64 por sinal em cada bloco
+  int getNumPalavras() const
+  {
+    return Npal;
+  }
+  // O numero de vetores de entrada simulados em cada bloco (64*getNumPalavras())
+  int getNumPadroes() const
+  {
+    return 64*Npal;
+  }
+
+  // Retorna a w-esima palavra (64 valores) da saida do circuito cuja id eh IdOutput.
+  // Gera excecao se algum parametro for invalido.
+  bool3S64 getOutputCirc(int IdOutput, int w=0) const;
+
+  // Retorna a w-esima palavra (64 valores) da saida da porta cuja id eh IdPort.
+  // Gera excecao se algum parametro for invalido.
+  bool3S64 getOutputPort(int IdPort, int w=0) const;
+
+  /// ***********************
+  /// SIMULACAO
+  /// ***********************
+
+  // Calcula as saidas do circuito para um bloco de getNumPadroes() vetores de entrada:
+  // in_circ deve ter getNumInputs()*getNumPalavras() elementos, e o k-esimo valor de
+  // in_circ.at(i*getNumPalavras()+w) eh o valor da entrada id=-(i+1) no vetor 64*w+k do bloco.
+  // Se o parametro for invalido, gera excecao.
+  void simular(const std::vector<bool3S64>& in_circ);
+};
+
+#endif // _SIMULADORBITS_H_
@@ -0,0 +1,216 @@
+#include <stdexcept>
+#include <algorithm>
+#include <deque>
+#include <mutex>
+#include <thread>
+#include <exception>
+#include <memory>
+#include "tabelaverdade.h"
+#include "circuitoimutavel.h"
+
+///
+/// CLASSE TABELAVERDADE
+///
+
+namespace {
+
+// Os blocos de trabalho (indices de blocos de linhas) ainda nao iniciados por uma thread
+struct FilaBlocos
+{
+  std::mutex trava;
+  std::deque<int> blocos;
+};
+
+// Obtem o proximo bloco para a thread t: primeiro do inicio da sua propria fila;
+// se ela estiver vazia, rouba do fim da fila de outra thread.
+// Retorna false se nao houver mais nenhum bloco.
+bool proximoBloco(std::vector<FilaBlocos>& filas, int t, int& bloco)
+{
+  int N = int(filas.size());
+  {
+    std::lock_guard<std::mutex> trava(filas[t].trava);
+    if (!filas[t].blocos.empty())
+    {
+      bloco = filas[t].blocos.front();
+      filas[t].blocos.pop_front();
+      return true;
+    }
+  }
+  for (int d=1; d<N; ++d)
+  {
+    FilaBlocos& F = filas[(t+d)%N];
+    std::lock_guard<std::mutex> trava(F.trava);
+    if (!F.blocos.empty())
+    {
+      bloco = F.blocos.back();
+      F.blocos.pop_back();
+      return true;
+    }
+  }
+  return false;
+}
+
+} // namespace
+
+const int TabelaVerdade::MAX_ENTRADAS;
+const int TabelaVerdade::DIGITOS_POR_BLOCO;
+
+/// Escreve em in_circ os Nin valores de entrada da linha Linha
+void TabelaVerdade::entradasLinha(int Linha, int Nin, bool3S* in_circ)
+{
+  for (int i=Nin-1; i>=0; --i)
+  {
+    in_circ[i] = bool3S(Linha%3);
+    Linha /= 3;
+  }
+}
+
+/// Calcula a tabela verdade do circuito C usando Nthreads threads, na ordem E.
+TabelaVerdade::TabelaVerdade(const Circuito& C, int Nthreads, EnumeracaoTabela E)
+    : Nin_circ(C.getNumInputs()),
+      Nout_circ(C.getNumOutputs()),
+      Nlinhas(1),
+      saidas()
+{
+  if (!C.valid()) throw std::logic_error("TabelaVerdade: invalid circuit");
+  if (Nin_circ > MAX_ENTRADAS) throw std::invalid_argument("TabelaVerdade: too many inputs");
+
+  for (int i=0; i<Nin_circ; ++i) Nlinhas *= 3;
+  saidas.resize(size_t(Nlinhas)*Nout_circ);
+
+  // Cada bloco fixa as primeiras entradas e percorre todas as combinacoes das Ndig ultimas
+  int Ndig = std::min(Nin_circ, int(DIGITOS_POR_BLOCO));
+  int Nbloco = 1;
+  for (int i=0; i<Ndig; ++i) Nbloco *= 3;
+  int Nblocos = Nlinhas/Nbloco;
+  if (Nthreads <= 0) Nthreads = std::max(1, int(std::thread::hardware_concurrency()));
+  Nthreads = std::min(Nthreads, Nblocos);
+
+  // Distribuicao inicial: cada thread recebe uma faixa contigua de blocos
+  std::vector<FilaBlocos> filas(Nthreads);
+  for (int t=0; t<Nthreads; ++t)
+  {
+    int b0 = int((long long)Nblocos*t/Nthreads);
+    int b1 = int((long long)Nblocos*(t+1)/Nthreads);
+    for (int b=b0; b<b1; ++b) filas[t].blocos.push_back(b);
+  }
+
+  // A primeira excecao gerada por alguma thread (p.ex. falta de memoria)
+  std::exception_ptr erro;
+  std::mutex trava_erro;
+
+  // Todas as threads simulam o mesmo circuito compilado, cada uma com seu proprio estado
+  std::shared_ptr<const CircuitoImutavel> Ci = C.compilar();
+
+  auto trabalhador = [&](int t)
+  {
+    try
+    {
+      EstadoSimulacao Et;
+      std::vector<bool3S> in_lote(size_t(Nbloco)*Nin_circ);
+      // Na ordem de Gray: as saidas e o indice canonico de cada linha simulada
+      std::vector<bool3S> out_lote;
+      std::vector<int> linha;
+      // O sentido (+1 ou -1) em que varia cada uma das Ndig ultimas entradas
+      std::vector<int> sentido(Ndig);
+      if (E == EnumeracaoTabela::GRAY)
+      {
+        out_lote.resize(size_t(Nbloco)*Nout_circ);
+        linha.resize(Nbloco);
+      }
+      int bloco;
+      while (proximoBloco(filas, t, bloco))
+      {
+        int L0 = bloco*Nbloco;
+        bool3S* in = in_lote.data();
+        entradasLinha(L0, Nin_circ, in);
+
+        if (E == EnumeracaoTabela::CRESCENTE)
+        {
+          // Gera as combinacoes de entrada do bloco, incrementando a partir da primeira
+          for (int k=1; k<Nbloco; ++k)
+          {
+            bool3S* ant = in;
+            in += Nin_circ;
+            std::copy(ant, ant+Nin_circ, in);
+            int i = Nin_circ-1;
+            while (i>=0 && in[i]==bool3S::TRUE)
+            {
+              ++in[i];
+              --i;
+            }
+            if (i>=0) ++in[i];
+          }
+          Ci->simularLote(in_lote.data(), Nbloco, saidas.data()+size_t(L0)*Nout_circ, Et);
+        }
+        else
+        {
+          // Codigo de Gray ternario refletido: a ultima entrada varia mais rapido e, quando
+          // uma entrada nao pode mais variar no seu sentido, ela inverte o sentido e
+          // a entrada anterior eh que muda. Assim, exatamente uma entrada muda a cada passo.
+          std::fill(sentido.begin(), sentido.end(), 1);
+          linha[0] = L0;
+          for (int k=1; k<Nbloco; ++k)
+          {
+            bool3S* ant = in;
+            in += Nin_circ;
+            std::copy(ant, ant+Nin_circ, in);
+            linha[k] = linha[k-1];
+            int peso = 1;
+            for (int d=Ndig-1; d>=0; --d)
+            {
+              int i = Nin_circ-Ndig+d;
+              int novo = int(in[i])+sentido[d];
+              if (novo>=0 && novo<=2)
+              {
+                in[i] = bool3S(novo);
+                linha[k] += sentido[d]*peso;
+                break;
+              }
+              sentido[d] = -sentido[d];
+              peso *= 3;
+            }
+          }
+          Ci->simularLoteIncremental(in_lote.data(), Nbloco, out_lote.data(), Et);
+
+          // Guarda cada linha no seu indice canonico
+          for (int k=0; k<Nbloco; ++k)
+          {
+            std::copy(out_lote.data()+size_t(k)*Nout_circ, out_lote.data()+size_t(k+1)*Nout_circ,
+                      saidas.data()+size_t(linha[k])*Nout_circ);
+          }
+        }
+      }
+    }
+    catch (...)
+    {
+      std::lock_guard<std::mutex> trava(trava_erro);
+      if (!erro) erro = std::current_exception();
+    }
+  };
+
+  // A thread atual tambem trabalha, como a thread 0
+  std::vector<std::thread> threads;
+  for (int t=1; t<Nthreads; ++t) threads.emplace_back(trabalhador, t);
+  trabalhador(0);
+  for (auto& T : threads) T.join();
+
+  if (erro) std::rethrow_exception(erro);
+}
+
+/// Retorna o valor da entrada cuja id eh IdInput na linha Linha.
+bool3S TabelaVerdade::getInput(int Linha, int IdInput) const
+{
+  if (Linha<0 || Linha>=Nlinhas) throw std::out_of_range("getInput: invalid line");
+  if (IdInput>-1 || IdInput<-getNumInputs()) throw std::out_of_range("getInput: invalid ID");
+  for (int i=getNumInputs(); i>-IdInput; --i) Linha /= 3;
+  return bool3S(Linha%3);
+}
+
+/// Retorna o valor da saida cuja id eh IdOutput na linha Linha.
+bool3S TabelaVerdade::getOutput(int Linha, int IdOutput) const
+{
+  if (Linha<0 || Linha>=Nlinhas) throw std::out_of_range("getOutput: invalid line");
+  if (IdOutput<1 || IdOutput>getNumOutputs()) throw std::out_of_range("getOutput: invalid ID");
+  return saidas[size_t(Linha)*Nout_circ+IdOutput-1];
+}
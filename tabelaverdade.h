@@ -0,0 +1,86 @@
+#ifndef _TABELAVERDADE_H_
+#define _TABELAVERDADE_H_
+
+#include <vector>
+#include "bool3S.h"
+#include "circuito.h"
+
+///
+/// CLASSE TABELAVERDADE
+///
+
+// A tabela verdade de um circuito: as saidas para todas as 3^N combinacoes das N entradas.
+// A linha L corresponde aa combinacao de entrada obtida escrevendo L na base 3 com N digitos,
+// sendo a entrada id=-1 o digito mais significativo e o digito d o valor bool3S(d)
+// (0: UNDEF, 1: FALSE, 2: TRUE). Essa eh a mesma ordem gerada pelo operador ++ de bool3S
+// a partir de todas as entradas UNDEF, incrementando primeiro a ultima entrada.
+//
+// A tabela eh calculada em paralelo: as linhas sao divididas em blocos de 3^DIGITOS_POR_BLOCO
+// linhas consecutivas (as que so diferem nas ultimas entradas), distribuidos entre
+// as threads. Quando uma thread termina seus blocos, ela "rouba" blocos ainda nao iniciados
+// de outra thread (work stealing), pois o custo de cada bloco varia com o numero de iteracoes
+// necessarias para os lacos do circuito. Todas as threads simulam um unico CircuitoImutavel,
+// cada uma com seu proprio EstadoSimulacao, e escrevem as saidas diretamente nas linhas de
+// seus blocos, de modo que o resultado nao depende do numero de threads nem da ordem de execucao.
+//
+// Dentro de cada bloco, as linhas podem ser simuladas em ordem crescente (cada linha simulada
+// desde o inicio) ou em codigo de Gray ternario refletido: a cada passo exatamente uma entrada
+// muda de valor (de um nivel para o vizinho: UNDEF<->FALSE ou FALSE<->TRUE), e apenas as
+// portas afetadas por essa entrada sao reavaliadas (Circuito::simularLoteIncremental).
+// Em qualquer caso, cada linha eh guardada no seu indice canonico.
+
+// A ordem de simulacao das linhas de cada bloco da tabela verdade
+enum class EnumeracaoTabela {CRESCENTE, GRAY};
+
+class TabelaVerdade
+{
+private:
+  // NUMERO DE ENTRADAS E SAIDAS DO CIRCUITO E NUMERO DE LINHAS DA TABELA
+  int Nin_circ;
+  int Nout_circ;
+  int Nlinhas;
+
+  // AS SAIDAS: a saida id=j+1 na linha L estah em saidas[L*Nout_circ+j]
+  std::vector<bool3S> saidas;
+
+public:
+  // O maior numero de entradas aceito (3^19 linhas)
+  static const int MAX_ENTRADAS = 19;
+  // Cada bloco de trabalho tem 3^DIGITOS_POR_BLOCO linhas (ou todas, se houver menos entradas)
+  static const int DIGITOS_POR_BLOCO = 7;
+
+  // Nao existe tabela sem circuito
+  TabelaVerdade() = delete;
+  // Calcula a tabela verdade do circuito C usando Nthreads threads
+  // (Nthreads<=0: o numero de processadores disponiveis), simulando as linhas
+  // de cada bloco na ordem E. O resultado eh o mesmo qualquer que seja a ordem.
+  // Se o circuito for invalido ou tiver mais de MAX_ENTRADAS entradas, gera excecao.
+  explicit TabelaVerdade(const Circuito& C, int Nthreads=0,
+                         EnumeracaoTabela E=EnumeracaoTabela::GRAY);
+
+  int getNumInputs() const
+  {
+    return Nin_circ;
+  }
+  int getNumOutputs() const
+  {
+    return Nout_circ;
+  }
+  int getNumLinhas() const
+  {
+    return Nlinhas;
+  }
+
+  // Retorna o valor da entrada cuja id eh IdInput na linha Linha.
+  // Gera excecao se algum parametro for invalido.
+  bool3S getInput(int Linha, int IdInput) const;
+
+  // Retorna o valor da saida cuja id eh IdOutput na linha Linha.
+  // Gera excecao se algum parametro for invalido.
+  bool3S getOutput(int Linha, int IdOutput) const;
+
+  // Escreve em in_circ os Nin valores de entrada da linha Linha de uma tabela com Nin entradas
+  static void entradasLinha(int Linha, int Nin, bool3S* in_circ);
+};
+
+#endif // _TABELAVERDADE_H_
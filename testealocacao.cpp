@@ -0,0 +1,154 @@
+// Teste: depois da primeira simulacao (aquecimento), as simulacoes de um circuito
+// nao devem fazer nenhuma alocacao de memoria.
+// Os operadores globais new e delete sao substituidos por versoes que contam as alocacoes.
+//
+// Compilacao (fora do Qt):
+// g++ -std=c++11 testealocacao.cpp bool3S.cpp porta.cpp circuito.cpp simuladorbits.cpp
+//     kernelsportas.cpp kernelsportas_avx2.cpp kernelsportas_avx512.cpp -o testealocacao
+// Uso: testealocacao (retorna 0 se nao houve nenhuma alocacao depois do aquecimento)
+
+#include <iostream>
+#include <cstdlib>
+#include <new>
+#include "circuito.h"
+#include "simuladorbits.h"
+
+using namespace std;
+
+// Numero de alocacoes feitas enquanto "contando" for true
+static long Nalocacoes = 0;
+static bool contando = false;
+
+void* operator new(size_t n)
+{
+  if (contando) ++Nalocacoes;
+  void* p = malloc(n>0 ? n : 1);
+  if (p == nullptr) throw bad_alloc();
+  return p;
+}
+
+void operator delete(void* p) noexcept
+{
+  free(p);
+}
+
+void operator delete(void* p, size_t) noexcept
+{
+  free(p);
+}
+
+// Gera o proximo vetor de entradas (todas as combinacoes de ?, F e T, em sequencia)
+void proximo(vector<bool3S>& in_circ)
+{
+  int i = int(in_circ.size())-1;
+  while (i>=0 && in_circ[i]==bool3S::TRUE)
+  {
+    ++in_circ[i];
+    --i;
+  }
+  if (i>=0) ++in_circ[i];
+}
+
+int main(void)
+{
+  int erros = 0;
+
+  // Circuito de circuito.txt, com um laco (latch com portas NAND) acrescentado
+  Circuito C(3, 4, 9);
+  C.setPort(1,"OR",3); C.setIdInPort(1,0,2);  C.setIdInPort(1,1,-1); C.setIdInPort(1,2,-2);
+  C.setPort(2,"AN",3); C.setIdInPort(2,0,-1); C.setIdInPort(2,1,-2); C.setIdInPort(2,2,3);
+  C.setPort(3,"NO",2); C.setIdInPort(3,0,-2); C.setIdInPort(3,1,-3);
+  C.setPort(4,"NT",1); C.setIdInPort(4,0,2);
+  C.setPort(5,"NA",3); C.setIdInPort(5,0,2);  C.setIdInPort(5,1,1);  C.setIdInPort(5,2,6);
+  C.setPort(6,"XO",2); C.setIdInPort(6,0,1);  C.setIdInPort(6,1,4);
+  C.setPort(7,"NX",2); C.setIdInPort(7,0,4);  C.setIdInPort(7,1,-3);
+  C.setPort(8,"NA",2); C.setIdInPort(8,0,-1); C.setIdInPort(8,1,9);
+  C.setPort(9,"NA",2); C.setIdInPort(9,0,-2); C.setIdInPort(9,1,8);
+  C.setIdOutputCirc(1,5); C.setIdOutputCirc(2,-3); C.setIdOutputCirc(3,7); C.setIdOutputCirc(4,8);
+
+  vector<bool3S> in_circ(3, bool3S::UNDEF);
+
+  // Aquecimento: a primeira simulacao calcula a ordem de avaliacao e as filas
+  C.simular(in_circ);
+  C.simularIncremental(in_circ);
+  SimuladorBits S(C);
+  vector<bool3S64> in_bits(3*S.getNumPalavras());
+  S.simular(in_bits);
+  PortaAND P(3);
+  bool3S in_port[3] = {bool3S::TRUE, bool3S::UNDEF, bool3S::FALSE};
+
+  cout << "Circuito::simular\n";
+  contando = true;
+  for (int k=0; k<2700; ++k)
+  {
+    C.simular(in_circ);
+    proximo(in_circ);
+  }
+  contando = false;
+  if (Nalocacoes != 0) { cerr << "Erro: " << Nalocacoes << " alocacoes em Circuito::simular\n"; ++erros; }
+
+  cout << "Circuito::simularIncremental\n";
+  Nalocacoes = 0;
+  contando = true;
+  for (int k=0; k<2700; ++k)
+  {
+    C.simularIncremental(in_circ);
+    proximo(in_circ);
+  }
+  contando = false;
+  if (Nalocacoes != 0) { cerr << "Erro: " << Nalocacoes << " alocacoes em Circuito::simularIncremental\n"; ++erros; }
+
+  cout << "Circuito::simularLote\n";
+  vector<bool3S> in_lote(3*27), out_lote;
+  for (int v=0; v<27; ++v)
+  {
+    for (int i=0; i<3; ++i) in_lote[3*v+i] = in_circ[i];
+    proximo(in_circ);
+  }
+  C.simularLote(in_lote, out_lote);
+  Nalocacoes = 0;
+  contando = true;
+  for (int k=0; k<100; ++k)
+  {
+    C.simularLote(in_lote, out_lote);
+  }
+  contando = false;
+  if (Nalocacoes != 0) { cerr << "Erro: " << Nalocacoes << " alocacoes em Circuito::simularLote\n"; ++erros; }
+
+  cout << "Circuito::simularCone\n";
+  vector<int> saidas = {3, 4};
+  C.simularCone(saidas, in_circ);
+  Nalocacoes = 0;
+  contando = true;
+  for (int k=0; k<2700; ++k)
+  {
+    C.simularCone(saidas, in_circ);
+    proximo(in_circ);
+  }
+  contando = false;
+  if (Nalocacoes != 0) { cerr << "Erro: " << Nalocacoes << " alocacoes em Circuito::simularCone\n"; ++erros; }
+
+  cout << "SimuladorBits::simular\n";
+  Nalocacoes = 0;
+  contando = true;
+  for (int k=0; k<100; ++k)
+  {
+    in_bits[k%3].t = ~in_bits[k%3].t | 1;
+    S.simular(in_bits);
+  }
+  contando = false;
+  if (Nalocacoes != 0) { cerr << "Erro: " << Nalocacoes << " alocacoes em SimuladorBits::simular\n"; ++erros; }
+
+  cout << "Porta::simular\n";
+  Nalocacoes = 0;
+  contando = true;
+  for (int k=0; k<100; ++k)
+  {
+    P.simular(in_port, 3);
+  }
+  contando = false;
+  if (Nalocacoes != 0) { cerr << "Erro: " << Nalocacoes << " alocacoes em Porta::simular\n"; ++erros; }
+
+  cout << (erros==0 ? "OK\n" : "FALHOU\n");
+  return erros;
+}
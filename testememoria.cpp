@@ -0,0 +1,87 @@
+// Teste de estresse: alterar repetidamente as mesmas portas de um circuito (setPort,
+// setIdInPort) nao deve aumentar a memoria usada pelo processo. O espaco das conexoes
+// abandonado pelas portas alteradas deve ser reaproveitado.
+// A memoria residente (RSS) eh lida de /proc/self/statm (Linux); em outros sistemas,
+// o teste apenas executa as alteracoes.
+//
+// Compilacao (fora do Qt):
+// g++ -std=c++11 -O2 testememoria.cpp bool3S.cpp porta.cpp circuito.cpp -o testememoria
+// Uso: testememoria [num_alteracoes] (retorna 0 se a memoria ficou estavel)
+
+#include <iostream>
+#include <fstream>
+#include <string>
+#include <cstdlib>
+#include <unistd.h>
+#include "circuito.h"
+
+using namespace std;
+
+// Retorna a memoria residente do processo, em KB (0 se nao for possivel ler)
+static long memoriaResidente()
+{
+  ifstream statm("/proc/self/statm");
+  long total, residente;
+  if (!(statm >> total >> residente)) return 0;
+  return residente*(sysconf(_SC_PAGESIZE)/1024);
+}
+
+int main(int argc, char** argv)
+{
+  long Nalteracoes = (argc > 1 ? atol(argv[1]) : 2000000);
+  const int NI = 8, NO = 4, NP = 20000;
+  const string tipos[] = {"AN", "NA", "OR", "NO", "XO", "NX"};
+
+  // Um circuito em cadeia: cada porta depende da anterior e de uma entrada
+  Circuito C(NI, NO, NP);
+  for (int id=1; id<=NP; ++id)
+  {
+    C.setPort(id, "AN", 2);
+    C.setIdInPort(id, 0, (id==1 ? -1 : id-1));
+    C.setIdInPort(id, 1, -(1+id%NI));
+  }
+  for (int id=1; id<=NO; ++id) C.setIdOutputCirc(id, NP-id+1);
+  vector<bool3S> in_circ(NI, bool3S::TRUE);
+
+  // As portas alteradas: a primeira, uma do meio e a ultima
+  const int alteradas[] = {1, NP/2, NP};
+  long rss_ini = 0;
+  unsigned x = 12345;
+  for (long k=0; k<Nalteracoes; ++k)
+  {
+    // Um numero de entradas pseudo-aleatorio entre 2 e 33
+    x = x*1103515245u + 12345u;
+    int id = alteradas[k%3];
+    int Nin = 2 + int((x>>16)%32);
+    C.setPort(id, tipos[(x>>8)%6], Nin);
+    for (int j=0; j<Nin; ++j) C.setIdInPort(id, j, -(1+(j+k)%NI));
+    if (id > 1) C.setIdInPort(id, 0, id-1);
+
+    // De tempos em tempos, simula o circuito e altera uma copia (que deixa de compartilhar a
+    // estrutura com o original e depois eh descartada)
+    if (k%1000 == 0)
+    {
+      C.simular(in_circ);
+      Circuito copia(C);
+      copia.setPort(NP, "OR", 2);
+    }
+    // A memoria de referencia eh medida depois de um aquecimento
+    if (k == Nalteracoes/10) rss_ini = memoriaResidente();
+  }
+  long rss_fim = memoriaResidente();
+
+  if (rss_ini == 0 || rss_fim == 0)
+  {
+    cout << "RSS indisponivel: memoria nao verificada\n";
+    return 0;
+  }
+  cout << Nalteracoes << " alteracoes: RSS " << rss_ini << " KB -> " << rss_fim << " KB\n";
+  // Tolerancia para variacoes do alocador
+  if (rss_fim > rss_ini + 1024)
+  {
+    cerr << "Erro: a memoria cresceu " << rss_fim-rss_ini << " KB\n";
+    return 1;
+  }
+  cout << "OK\n";
+  return 0;
+}